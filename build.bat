@@ -8,5 +8,10 @@ if exist "%~dp0bin\program.exe" del /q "%~dp0bin\program.exe"
 rem Create the bin directory if it doesn't exist
 if not exist "%~dp0bin" mkdir "%~dp0bin"
 
+rem Regenerate the compiled-in glyph table from ascii_base.txt
+gcc -O2 "%~dp0source\generate_ascii_table.c" -o "%~dp0bin\generate_ascii_table.exe"
+"%~dp0bin\generate_ascii_table.exe" "%~dp0ascii_base.txt" "%~dp0headers\ascii_table.h"
+if errorlevel 1 exit /b 1
+
 rem Compile with debugging symbols (-g flag)
 gcc -g -I"%~dp0headers" -LC:/MinGW/lib "%~dp0source\main.c" -o "%~dp0bin\program.exe" -lmingw32
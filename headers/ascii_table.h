@@ -0,0 +1,248 @@
+// Generated from ascii_base.txt by source/generate_ascii_table.c, do not edit by hand.
+#ifndef ASCII_TABLE_H
+#define ASCII_TABLE_H
+
+#define ASCII_TABLE_ROWS 16
+#define ASCII_TABLE_COLS 16
+
+// Number of glyphs, sorted by ASCII code
+#define ASCII_TABLE_COUNT 76
+
+// Packed rows per glyph, bit N is column N
+#define ASCII_TABLE_MATRICES \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, /* ' ' */ \
+	{{0x0198, 0x0198, 0x0198, 0x0198, 0x07FE, 0x07FE, 0x0198, 0x0198, 0x07FE, 0x07FE, 0x0198, 0x0198, 0x0198, 0x0198, 0x0000, 0x0000}}, /* '#' */ \
+	{{0x0606, 0x0606, 0x0186, 0x0186, 0x0180, 0x0180, 0x0060, 0x0060, 0x0018, 0x0018, 0x0618, 0x0618, 0x0606, 0x0606, 0x0000, 0x0000}}, /* '%' */ \
+	{{0x0060, 0x0060, 0x0018, 0x0018, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0018, 0x0018, 0x0060, 0x0060, 0x0000, 0x0000}}, /* '(' */ \
+	{{0x0006, 0x0006, 0x0018, 0x0018, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0018, 0x0018, 0x0006, 0x0006, 0x0000, 0x0000}}, /* ')' */ \
+	{{0x0000, 0x0000, 0x0060, 0x0060, 0x0060, 0x0060, 0x07FE, 0x07FE, 0x0060, 0x0060, 0x0060, 0x0060, 0x0000, 0x0000, 0x0000, 0x0000}}, /* '+' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0006, 0x0006, 0x0006, 0x0006}}, /* ',' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x07FE, 0x07FE, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, /* '-' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0006, 0x0006, 0x0000, 0x0000}}, /* '.' */ \
+	{{0x0600, 0x0600, 0x0180, 0x0180, 0x0180, 0x0180, 0x0060, 0x0060, 0x0018, 0x0018, 0x0018, 0x0018, 0x0006, 0x0006, 0x0000, 0x0000}}, /* '/' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0786, 0x0786, 0x0666, 0x0666, 0x061E, 0x061E, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* '0' */ \
+	{{0x0060, 0x0060, 0x0078, 0x0078, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x07FE, 0x07FE, 0x0000, 0x0000}}, /* '1' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0600, 0x0600, 0x01E0, 0x01E0, 0x0018, 0x0018, 0x0606, 0x0606, 0x07FE, 0x07FE, 0x0000, 0x0000}}, /* '2' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0600, 0x0600, 0x01E0, 0x01E0, 0x0600, 0x0600, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* '3' */ \
+	{{0x0780, 0x0780, 0x0660, 0x0660, 0x0618, 0x0618, 0x0606, 0x0606, 0x07FE, 0x07FE, 0x0600, 0x0600, 0x0600, 0x0600, 0x0000, 0x0000}}, /* '4' */ \
+	{{0x07FE, 0x07FE, 0x0006, 0x0006, 0x01FE, 0x01FE, 0x0600, 0x0600, 0x0600, 0x0600, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* '5' */ \
+	{{0x01E0, 0x01E0, 0x0018, 0x0018, 0x0006, 0x0006, 0x01FE, 0x01FE, 0x0606, 0x0606, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* '6' */ \
+	{{0x07FE, 0x07FE, 0x0606, 0x0606, 0x0600, 0x0600, 0x0180, 0x0180, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0000, 0x0000}}, /* '7' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0606, 0x0606, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* '8' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0606, 0x0606, 0x07F8, 0x07F8, 0x0600, 0x0600, 0x0180, 0x0180, 0x0078, 0x0078, 0x0000, 0x0000}}, /* '9' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0006, 0x0006, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0006, 0x0006, 0x0000, 0x0000}}, /* ':' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0006, 0x0006, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0006, 0x0006, 0x0006, 0x0006}}, /* ';' */ \
+	{{0x0000, 0x0000, 0x07F8, 0x07F8, 0x1806, 0x1806, 0x19E6, 0x19E6, 0x1866, 0x1866, 0x1FE6, 0x1FE6, 0x0006, 0x0006, 0x07F8, 0x07F8}}, /* '@' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x07FE, 0x07FE, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'A' */ \
+	{{0x01FE, 0x01FE, 0x0606, 0x0606, 0x01FE, 0x01FE, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x01FE, 0x01FE, 0x0000, 0x0000}}, /* 'B' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'C' */ \
+	{{0x01FE, 0x01FE, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x01FE, 0x01FE, 0x0000, 0x0000}}, /* 'D' */ \
+	{{0x07FE, 0x07FE, 0x0006, 0x0006, 0x007E, 0x007E, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x07FE, 0x07FE, 0x0000, 0x0000}}, /* 'E' */ \
+	{{0x07FE, 0x07FE, 0x0006, 0x0006, 0x007E, 0x007E, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0000, 0x0000}}, /* 'F' */ \
+	{{0x07F8, 0x07F8, 0x0006, 0x0006, 0x0786, 0x0786, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'G' */ \
+	{{0x0606, 0x0606, 0x0606, 0x0606, 0x07FE, 0x07FE, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'H' */ \
+	{{0x007E, 0x007E, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x007E, 0x007E, 0x0000, 0x0000}}, /* 'I' */ \
+	{{0x0600, 0x0600, 0x0600, 0x0600, 0x0600, 0x0600, 0x0600, 0x0600, 0x0600, 0x0600, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'J' */ \
+	{{0x0606, 0x0606, 0x0186, 0x0186, 0x007E, 0x007E, 0x0186, 0x0186, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'K' */ \
+	{{0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x07FE, 0x07FE, 0x0000, 0x0000}}, /* 'L' */ \
+	{{0x0606, 0x0606, 0x079E, 0x079E, 0x0666, 0x0666, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'M' */ \
+	{{0x0606, 0x0606, 0x061E, 0x061E, 0x0666, 0x0666, 0x0786, 0x0786, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'N' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'O' */ \
+	{{0x01FE, 0x01FE, 0x0606, 0x0606, 0x01FE, 0x01FE, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0000, 0x0000}}, /* 'P' */ \
+	{{0x01F8, 0x01F8, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0186, 0x0186, 0x0678, 0x0678, 0x0000, 0x0000}}, /* 'Q' */ \
+	{{0x01FE, 0x01FE, 0x0606, 0x0606, 0x01FE, 0x01FE, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'R' */ \
+	{{0x07F8, 0x07F8, 0x0006, 0x0006, 0x01F8, 0x01F8, 0x0600, 0x0600, 0x0600, 0x0600, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'S' */ \
+	{{0x07FE, 0x07FE, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0000, 0x0000}}, /* 'T' */ \
+	{{0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'U' */ \
+	{{0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0198, 0x0198, 0x0198, 0x0198, 0x0060, 0x0060, 0x0000, 0x0000}}, /* 'V' */ \
+	{{0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0666, 0x0666, 0x079E, 0x079E, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'W' */ \
+	{{0x0606, 0x0606, 0x0198, 0x0198, 0x0060, 0x0060, 0x0198, 0x0198, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'X' */ \
+	{{0x0606, 0x0606, 0x0198, 0x0198, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0000, 0x0000}}, /* 'Y' */ \
+	{{0x07FE, 0x07FE, 0x0600, 0x0600, 0x0180, 0x0180, 0x0060, 0x0060, 0x0018, 0x0018, 0x0006, 0x0006, 0x07FE, 0x07FE, 0x0000, 0x0000}}, /* 'Z' */ \
+	{{0x007E, 0x007E, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x007E, 0x007E, 0x0000, 0x0000}}, /* '[' */ \
+	{{0x007E, 0x007E, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x0060, 0x007E, 0x007E, 0x0000, 0x0000}}, /* ']' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x07FE, 0x07FE}}, /* '_' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x01F8, 0x01F8, 0x0600, 0x0600, 0x07F8, 0x07F8, 0x0606, 0x0606, 0x07F8, 0x07F8, 0x0000, 0x0000}}, /* 'a' */ \
+	{{0x0006, 0x0006, 0x0006, 0x0006, 0x01E6, 0x01E6, 0x061E, 0x061E, 0x0606, 0x0606, 0x0606, 0x0606, 0x01FE, 0x01FE, 0x0000, 0x0000}}, /* 'b' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x01F8, 0x01F8, 0x0606, 0x0606, 0x0006, 0x0006, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'c' */ \
+	{{0x0600, 0x0600, 0x0600, 0x0600, 0x0678, 0x0678, 0x0786, 0x0786, 0x0606, 0x0606, 0x0606, 0x0606, 0x07F8, 0x07F8, 0x0000, 0x0000}}, /* 'd' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x01F8, 0x01F8, 0x0606, 0x0606, 0x07FE, 0x07FE, 0x0006, 0x0006, 0x07F8, 0x07F8, 0x0000, 0x0000}}, /* 'e' */ \
+	{{0x01E0, 0x01E0, 0x0018, 0x0018, 0x01FE, 0x01FE, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0000, 0x0000}}, /* 'f' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x07F8, 0x07F8, 0x0606, 0x0606, 0x0606, 0x0606, 0x07F8, 0x07F8, 0x0600, 0x0600, 0x01FE, 0x01FE}}, /* 'g' */ \
+	{{0x0006, 0x0006, 0x0006, 0x0006, 0x01E6, 0x01E6, 0x061E, 0x061E, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'h' */ \
+	{{0x0006, 0x0006, 0x0000, 0x0000, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0000, 0x0000}}, /* 'i' */ \
+	{{0x0006, 0x0006, 0x0006, 0x0006, 0x0186, 0x0186, 0x0066, 0x0066, 0x001E, 0x001E, 0x0066, 0x0066, 0x0186, 0x0186, 0x0000, 0x0000}}, /* 'k' */ \
+	{{0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0018, 0x0018, 0x0000, 0x0000}}, /* 'l' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x019E, 0x019E, 0x0666, 0x0666, 0x0666, 0x0666, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'm' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x01FE, 0x01FE, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'n' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x01F8, 0x01F8, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x01F8, 0x01F8, 0x0000, 0x0000}}, /* 'o' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x01E6, 0x01E6, 0x061E, 0x061E, 0x0606, 0x0606, 0x01FE, 0x01FE, 0x0006, 0x0006, 0x0006, 0x0006}}, /* 'p' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x01E6, 0x01E6, 0x061E, 0x061E, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0006, 0x0000, 0x0000}}, /* 'r' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x07F8, 0x07F8, 0x0006, 0x0006, 0x01F8, 0x01F8, 0x0600, 0x0600, 0x01FE, 0x01FE, 0x0000, 0x0000}}, /* 's' */ \
+	{{0x0018, 0x0018, 0x0018, 0x0018, 0x007E, 0x007E, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0018, 0x0060, 0x0060, 0x0000, 0x0000}}, /* 't' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x07F8, 0x07F8, 0x0000, 0x0000}}, /* 'u' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0198, 0x0198, 0x0060, 0x0060, 0x0000, 0x0000}}, /* 'v' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0606, 0x0606, 0x0606, 0x0606, 0x0666, 0x0666, 0x0666, 0x0666, 0x07F8, 0x07F8, 0x0000, 0x0000}}, /* 'w' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0606, 0x0606, 0x0198, 0x0198, 0x0060, 0x0060, 0x0198, 0x0198, 0x0606, 0x0606, 0x0000, 0x0000}}, /* 'x' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x0606, 0x07F8, 0x07F8, 0x0600, 0x0600, 0x01FE, 0x01FE}}, /* 'y' */ \
+	{{0x0000, 0x0000, 0x0000, 0x0000, 0x07FE, 0x07FE, 0x0180, 0x0180, 0x0060, 0x0060, 0x0018, 0x0018, 0x07FE, 0x07FE, 0x0000, 0x0000}}, /* 'z' */ \
+
+// ASCII code per glyph
+#define ASCII_TABLE_CODES \
+	32, \
+	35, \
+	37, \
+	40, \
+	41, \
+	43, \
+	44, \
+	45, \
+	46, \
+	47, \
+	48, \
+	49, \
+	50, \
+	51, \
+	52, \
+	53, \
+	54, \
+	55, \
+	56, \
+	57, \
+	58, \
+	59, \
+	64, \
+	65, \
+	66, \
+	67, \
+	68, \
+	69, \
+	70, \
+	71, \
+	72, \
+	73, \
+	74, \
+	75, \
+	76, \
+	77, \
+	78, \
+	79, \
+	80, \
+	81, \
+	82, \
+	83, \
+	84, \
+	85, \
+	86, \
+	87, \
+	88, \
+	89, \
+	90, \
+	91, \
+	93, \
+	95, \
+	97, \
+	98, \
+	99, \
+	100, \
+	101, \
+	102, \
+	103, \
+	104, \
+	105, \
+	107, \
+	108, \
+	109, \
+	110, \
+	111, \
+	112, \
+	114, \
+	115, \
+	116, \
+	117, \
+	118, \
+	119, \
+	120, \
+	121, \
+	122, \
+
+// Matrix width per glyph
+#define ASCII_TABLE_WIDTHS \
+	10, \
+	12, \
+	12, \
+	8, \
+	8, \
+	12, \
+	4, \
+	12, \
+	4, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	4, \
+	4, \
+	14, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	8, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	8, \
+	8, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	10, \
+	12, \
+	12, \
+	4, \
+	10, \
+	6, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	8, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+	12, \
+
+#endif
@@ -0,0 +1,285 @@
+// Columnar F3 dataset written by program.exe --columns <folder>: one file per field, each a small header followed by
+// one fixed-width value per frame, so a column can be memory-mapped and indexed by frame number without parsing.
+// Names (biomes, dimensions, blocks, fluids) are stored as ids into names.txt in the same folder, one name per line,
+// id 1 on the first line; id 0 means the field was not found.
+//
+// The format definitions are always available. To compile the reader, define F3_COLUMNS_IMPLEMENTATION in one C file
+// before including this header:
+//
+//	f3_column x;
+//	if (f3_column_open(&x, "output/columns", "x")) {
+//		const double *values = f3_column_f64(&x);
+//		for (uint64_t frame = 0; frame < x.count; frame++) ...
+//		f3_column_close(&x);
+//	}
+#ifndef F3_COLUMNS_H
+#define F3_COLUMNS_H
+
+#include <stdint.h>
+
+#define F3_COLUMNS_MAGIC "MCCL"
+#define F3_COLUMNS_VERSION 1
+#define F3_COLUMNS_EXTENSION ".col"
+#define F3_COLUMNS_NAMES_FILE "names.txt"
+
+// Value type of a column
+typedef enum {
+	F3_COLUMN_I64 = 1,
+	F3_COLUMN_F64,
+	F3_COLUMN_F32,
+	F3_COLUMN_I32,
+	F3_COLUMN_U16,
+	F3_COLUMN_U8,
+	F3_COLUMN_BYTES, // Fixed-width NUL-padded text
+} f3_column_type;
+
+// Header at the start of every column file, the values follow at F3_COLUMN_DATA_OFFSET. Only the first count
+// values are committed; a writer that stopped early may leave more behind them.
+typedef struct {
+	char magic[4];		 // F3_COLUMNS_MAGIC
+	uint16_t version;	 // F3_COLUMNS_VERSION
+	uint16_t type;		 // f3_column_type
+	uint32_t value_size; // Bytes per value
+	uint32_t reserved;
+	uint64_t count; // Frames in the column
+	uint64_t reserved2;
+} f3_column_header;
+
+#define F3_COLUMN_DATA_OFFSET 32 // sizeof(f3_column_header), keeps 8-byte values aligned in the mapping
+
+// Bits of the "fields" column, set when the frame had the line the field is parsed from. F3_NAMES_DROPPED marks a
+// frame with a name that was read but had no room in the names table, so its id is 0 although the field was found.
+#define F3_HAS_POSITION 0x01
+#define F3_HAS_BLOCK 0x02
+#define F3_HAS_CHUNK 0x04
+#define F3_HAS_FACING 0x08
+#define F3_HAS_LIGHT 0x10
+#define F3_HAS_TARGETED_BLOCK 0x20
+#define F3_HAS_TARGETED_FLUID 0x40
+#define F3_NAMES_DROPPED 0x80
+
+// Values of the "facing" column
+#define F3_FACING_UNKNOWN 0
+#define F3_FACING_NORTH 1
+#define F3_FACING_SOUTH 2
+#define F3_FACING_EAST 3
+#define F3_FACING_WEST 4
+
+// One memory-mapped column
+typedef struct {
+	const f3_column_header *header;
+	const void *values;
+	uint64_t count;	   // Committed values that are inside the file
+	uint64_t size; // Bytes mapped
+} f3_column;
+
+// Names table, loaded into memory
+typedef struct {
+	char *data;
+	const char **names; // Indexed by id, names[0] is NULL
+	uint32_t count;		// Highest id
+} f3_names;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int f3_column_open(f3_column *column, const char *folder, const char *name);
+void f3_column_close(f3_column *column);
+int f3_names_open(f3_names *names, const char *folder);
+void f3_names_close(f3_names *names);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Function to get the values of a column as the array type it holds, NULL when the column has another type
+static inline const int64_t *f3_column_i64(const f3_column *column) { return column->header->type == F3_COLUMN_I64 ? (const int64_t *)column->values : 0; }
+static inline const double *f3_column_f64(const f3_column *column) { return column->header->type == F3_COLUMN_F64 ? (const double *)column->values : 0; }
+static inline const float *f3_column_f32(const f3_column *column) { return column->header->type == F3_COLUMN_F32 ? (const float *)column->values : 0; }
+static inline const int32_t *f3_column_i32(const f3_column *column) { return column->header->type == F3_COLUMN_I32 ? (const int32_t *)column->values : 0; }
+static inline const uint16_t *f3_column_u16(const f3_column *column) { return column->header->type == F3_COLUMN_U16 ? (const uint16_t *)column->values : 0; }
+static inline const uint8_t *f3_column_u8(const f3_column *column) { return column->header->type == F3_COLUMN_U8 ? (const uint8_t *)column->values : 0; }
+
+// Function to get the text of one frame from a F3_COLUMN_BYTES column, not NUL-terminated when it fills the value
+static inline const char *f3_column_text(const f3_column *column, uint64_t frame) {
+	return column->header->type == F3_COLUMN_BYTES && frame < column->count ? (const char *)column->values + frame * column->header->value_size : 0;
+}
+
+// Function to get the name for an id, NULL for id 0 and unknown ids
+static inline const char *f3_name(const f3_names *names, uint32_t id) { return id <= names->count ? names->names[id] : 0; }
+
+#endif
+
+#ifdef F3_COLUMNS_IMPLEMENTATION
+#ifndef F3_COLUMNS_IMPLEMENTED
+#define F3_COLUMNS_IMPLEMENTED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Function to map a whole file read-only, the mapping is shared with every other process reading it through the page cache
+static const void *f3_map_file(const char *path, uint64_t *size) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	LARGE_INTEGER file_size;
+	HANDLE mapping = NULL;
+	const void *data = NULL;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (mapping) {
+		data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping); // The view keeps the mapping alive
+	}
+	CloseHandle(file);
+	*size = data ? (uint64_t)file_size.QuadPart : 0;
+	return data;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd); // The mapping keeps the file alive
+	if (data == MAP_FAILED)
+		return NULL;
+	*size = (uint64_t)st.st_size;
+	return data;
+#endif
+}
+
+// Function to release a mapping made by f3_map_file
+static void f3_unmap_file(const void *data, uint64_t size) {
+#ifdef _WIN32
+	(void)size;
+	UnmapViewOfFile(data);
+#else
+	munmap((void *)data, (size_t)size);
+#endif
+}
+
+// Function to get the size of one value of a column type, 0 for F3_COLUMN_BYTES (any width) and unknown types
+static uint32_t f3_column_type_size(uint16_t type) {
+	switch (type) {
+	case F3_COLUMN_I64:
+	case F3_COLUMN_F64:
+		return 8;
+	case F3_COLUMN_F32:
+	case F3_COLUMN_I32:
+		return 4;
+	case F3_COLUMN_U16:
+		return 2;
+	case F3_COLUMN_U8:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// Function to map the column file <folder>/<name>.col, returns 0 when it is missing or not a column file
+int f3_column_open(f3_column *column, const char *folder, const char *name) {
+	char path[1024];
+	memset(column, 0, sizeof(*column));
+	if (snprintf(path, sizeof(path), "%s/%s%s", folder, name, F3_COLUMNS_EXTENSION) >= (int)sizeof(path))
+		return 0;
+
+	uint64_t size;
+	const f3_column_header *header = (const f3_column_header *)f3_map_file(path, &size);
+	if (!header)
+		return 0;
+	if (size < F3_COLUMN_DATA_OFFSET || memcmp(header->magic, F3_COLUMNS_MAGIC, 4) != 0 || header->version != F3_COLUMNS_VERSION || header->value_size == 0 ||
+		(header->type != F3_COLUMN_BYTES && header->value_size != f3_column_type_size(header->type))) { // The typed accessors index by the C type
+		f3_unmap_file(header, size);
+		return 0;
+	}
+
+	column->header = header;
+	column->values = (const char *)header + F3_COLUMN_DATA_OFFSET;
+	column->size = size;
+	column->count = (size - F3_COLUMN_DATA_OFFSET) / header->value_size;
+	if (header->count < column->count) {
+		column->count = header->count;
+	}
+	return 1;
+}
+
+// Function to unmap a column
+void f3_column_close(f3_column *column) {
+	if (column->header) {
+		f3_unmap_file(column->header, column->size);
+	}
+	memset(column, 0, sizeof(*column));
+}
+
+// Function to load <folder>/names.txt, an empty table when the folder has no names yet
+int f3_names_open(f3_names *names, const char *folder) {
+	char path[1024];
+	memset(names, 0, sizeof(*names));
+	if (snprintf(path, sizeof(path), "%s/%s", folder, F3_COLUMNS_NAMES_FILE) >= (int)sizeof(path))
+		return 0;
+
+	FILE *file = fopen(path, "rb");
+	long length = 0;
+	if (file && (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0)) {
+		fclose(file);
+		return 0;
+	}
+
+	uint32_t lines = 0;
+	names->data = (char *)malloc((size_t)length + 1);
+	if (names->data && file && fread(names->data, 1, (size_t)length, file) != (size_t)length) {
+		length = -1;
+	}
+	if (file) {
+		fclose(file);
+	}
+	if (!names->data || length < 0) {
+		f3_names_close(names);
+		return 0;
+	}
+	names->data[length] = '\0';
+	for (long i = 0; i < length; i++) {
+		lines += names->data[i] == '\n';
+	}
+
+	names->names = (const char **)malloc((lines + 1) * sizeof(*names->names));
+	if (!names->names) {
+		f3_names_close(names);
+		return 0;
+	}
+	names->names[0] = NULL;
+	for (char *line = names->data; names->count < lines;) {
+		char *end = strchr(line, '\n');
+		*end = '\0';
+		names->names[++names->count] = line;
+		line = end + 1;
+	}
+	return 1;
+}
+
+// Function to free a names table
+void f3_names_close(f3_names *names) {
+	free(names->data);
+	free((void *)names->names);
+	memset(names, 0, sizeof(*names));
+}
+
+#endif
+#endif
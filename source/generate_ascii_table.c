@@ -0,0 +1,129 @@
+// Build step that turns the text glyph file (ascii_base.txt) into a C header with the packed glyph table,
+// so program.exe starts without reading or parsing the text file.
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_ASCII 123
+#define MATRIX_ROWS 16
+#define MATRIX_COLS 16
+
+uint16_t ascii_rows[MAX_ASCII][MATRIX_ROWS] = {{0}};
+int ascii_widths[MAX_ASCII] = {0};
+
+// Function to load and pack ASCII matrices from file, same rules as load_ascii_matrices in main.c
+int load_ascii_matrices(const char *filename) {
+	FILE *file = fopen(filename, "r");
+	if (!file) {
+		perror("Error opening glyph file");
+		return 0;
+	}
+
+	char line[64];
+	int ascii_code = -1;
+	int row = 0;
+
+	while (fgets(line, sizeof(line), file)) {
+		// Remove trailing newline
+		line[strcspn(line, "\r\n")] = 0;
+
+		if (strncmp(line, "ASCII", 5) == 0) {
+			sscanf(line, "ASCII %d:", &ascii_code);
+			row = 0; // Reset row counter
+		} else if (ascii_code >= 0 && isdigit(line[0])) {
+			if (row < MATRIX_ROWS && ascii_code < MAX_ASCII) {
+				uint16_t bits = 0;
+				for (int col = 0; col < MATRIX_COLS && line[col]; col++) {
+					if (line[col] == '1') {
+						bits |= (uint16_t)(1u << col);
+					}
+				}
+				ascii_rows[ascii_code][row] = bits;
+
+				int width = strlen(line);
+				if (width > MATRIX_COLS) {
+					width = MATRIX_COLS;
+				}
+				if (width > ascii_widths[ascii_code]) {
+					ascii_widths[ascii_code] = width;
+				}
+				row++;
+			}
+		}
+	}
+
+	fclose(file);
+	return 1;
+}
+
+// Function to write the packed table as designated-initializer lists for main.c
+int write_header(const char *filename, const char *source_name) {
+	FILE *file = fopen(filename, "w");
+	if (!file) {
+		perror("Error opening header file");
+		return 0;
+	}
+
+	fprintf(file, "// Generated from %s by source/generate_ascii_table.c, do not edit by hand.\n", source_name);
+	fprintf(file, "#ifndef ASCII_TABLE_H\n#define ASCII_TABLE_H\n\n");
+	fprintf(file, "#define ASCII_TABLE_ROWS %d\n#define ASCII_TABLE_COLS %d\n\n", MATRIX_ROWS, MATRIX_COLS);
+
+	int count = 0;
+	for (int ascii_code = 0; ascii_code < MAX_ASCII; ascii_code++) {
+		count += ascii_widths[ascii_code] != 0;
+	}
+	fprintf(file, "// Number of glyphs, sorted by ASCII code\n#define ASCII_TABLE_COUNT %d\n\n", count);
+
+	fprintf(file, "// Packed rows per glyph, bit N is column N\n#define ASCII_TABLE_MATRICES \\\n");
+	for (int ascii_code = 0; ascii_code < MAX_ASCII; ascii_code++) {
+		if (ascii_widths[ascii_code] == 0)
+			continue;
+
+		fprintf(file, "\t{{");
+		for (int row = 0; row < MATRIX_ROWS; row++) {
+			fprintf(file, "0x%04X%s", ascii_rows[ascii_code][row], row + 1 < MATRIX_ROWS ? ", " : "");
+		}
+		fprintf(file, "}}, /* '%c' */ \\\n", ascii_code);
+	}
+	fprintf(file, "\n");
+
+	fprintf(file, "// ASCII code per glyph\n#define ASCII_TABLE_CODES \\\n");
+	for (int ascii_code = 0; ascii_code < MAX_ASCII; ascii_code++) {
+		if (ascii_widths[ascii_code] != 0) {
+			fprintf(file, "\t%d, \\\n", ascii_code);
+		}
+	}
+	fprintf(file, "\n");
+
+	fprintf(file, "// Matrix width per glyph\n#define ASCII_TABLE_WIDTHS \\\n");
+	for (int ascii_code = 0; ascii_code < MAX_ASCII; ascii_code++) {
+		if (ascii_widths[ascii_code] != 0) {
+			fprintf(file, "\t%d, \\\n", ascii_widths[ascii_code]);
+		}
+	}
+	fprintf(file, "\n#endif\n");
+
+	fclose(file);
+	return 1;
+}
+
+int main(int argc, char **argv) {
+	if (argc != 3) {
+		printf("Usage: %s <ascii_base.txt> <ascii_table.h>\n", argv[0]);
+		return 1;
+	}
+
+	// Name only the glyph file in the header, not the build machine's path to it
+	const char *source_name = argv[1];
+	for (const char *c = argv[1]; *c; c++) {
+		if (*c == '/' || *c == '\\') {
+			source_name = c + 1;
+		}
+	}
+
+	if (!load_ascii_matrices(argv[1]) || !write_header(argv[2], source_name)) {
+		return 1;
+	}
+	return 0;
+}
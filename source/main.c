@@ -1,36 +1,967 @@
+#define _FILE_OFFSET_BITS 64 // Column files can outgrow a 32-bit off_t
 #define STB_IMAGE_IMPLEMENTATION
 #include "../headers/stb_image.h"
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "../headers/stb_image_write.h"
+#include "../headers/ascii_table.h"
+#include "../headers/f3_columns.h"
 #include <ctype.h>
 #include <dirent.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
 
 #define ASSETS_FOLDER "assets/"
 #define OUTPUT_FOLDER "output/"
 #define MAX_ASCII 123
+#define MAX_GLYPHS MAX_ASCII
 #define MATRIX_ROWS 16
-#define MATRIX_COLS 12
+#define MATRIX_COLS 16
+#define GLYPH_WORDS (MATRIX_ROWS / 4)
+#define GLYPH_INDEX_SIZE 256 // Power of two, at least twice MAX_GLYPHS so probe chains stay short
+#define BORDER_TOLERANCE 2	 // How many columns an extracted width may differ from a stored glyph width
+#define MAX_TREE_NODES (2 * MAX_GLYPHS)
+#define MAX_AUTOMATON_STATES (MAX_GLYPHS * MATRIX_COLS + 1)
+#define AUTOMATON_EDGE_SLOTS 4096 // Power of two, at least twice MAX_AUTOMATON_STATES; every state but the root has one incoming edge
+#define MAX_RUN_COLUMNS 256		  // Longest ink run the column automaton parses, longer runs go to the classifier
+#define LINE_CACHE_SETS 64		  // Power of two, sets of recently recognized line bitmaps
+#define LINE_CACHE_WAYS 4		  // Lines per set, the least recently used one is replaced
+#define INTERN_BLOCK_SIZE 65536	  // Bytes per block of interned names (biomes, blocks, fluids, dimensions), more blocks are added as needed
+#define MAX_INTERNED_NAMES 65535  // Name ids are 16 bits wide in the columnar dataset
+#define SOURCE_COLUMN_SIZE 64	  // Bytes of the screenshot file name kept in the columnar dataset
+#define GLYPH_SET_MAGIC "MCGS"
+#define GLYPH_SET_VERSION 1
+#define MIN_DETECTION_RUNS 64 // Text pixel runs needed before the GUI scale of a frame is trusted
+#define DETECTION_BLANK_ROWS (MAX_BLANK_LINES * 36) // Blank rows under the text that end profile detection, MAX_BLANK_LINES line pitches at GUI scale 4
+#define SCALE1_MAX_EVEN_PERCENT 75 // At most this share of even runs for GUI scale 1, scale 2 text has only even runs
+#define REDETECT_UNKNOWN_PERCENT 25 // Share of unknown glyphs in a frame that makes a detected profile suspect
+#define MIN_REDETECT_GLYPHS 64		// Glyphs a frame needs before its unknown-glyph share is trusted
+#define DEFAULT_MAX_DISTANCE 3 // Differing pixels still accepted as the nearest glyph, covers compression artefacts
+#define UNKNOWN_GLYPHS_FILE OUTPUT_FOLDER "unknown_glyphs.txt"
+#define UNKNOWN_SAMPLES 3 // Source locations kept per distinct unknown glyph
+#define PLANE_ALIGN 32	   // Bit plane rows start on this byte boundary, one AVX2 register
+#define MAX_BLANK_LINES 4  // Empty line pitches below the last text row that end the F3 panel; its sections are one blank line apart
+#define BINARIZE_BLOCK 32  // Pixels per binarization kernel iteration, region of interest columns are aligned to it
+#define ROI_MARGIN_LINES 3 // Line pitches of room a learned panel region leaves around the text it was learned from
+
+// Bit-packed character matrix: one 16-bit mask per row, bit N is column N (leftmost column is bit 0).
+// The same storage viewed as 64-bit words lets a whole glyph be compared in GLYPH_WORDS XOR/OR steps.
+typedef union {
+	uint16_t rows[MATRIX_ROWS];
+	uint64_t words[GLYPH_WORDS];
+} packed_glyph;
+
+// Decision tree node: inner nodes probe one pixel and branch on it, leaves (row < 0) name a single candidate
+typedef struct {
+	int8_t row;
+	int8_t col;
+	int16_t glyph;
+	int16_t children[2];
+} glyph_tree_node;
+
+// Aho-Corasick automaton over the ink column words of a glyph set. Each state is a prefix of some glyph's columns;
+// edges live in one hash table keyed by (state, column word), since column words are a sparse 16-bit alphabet.
+typedef struct {
+	int state_count;
+	int16_t fail[MAX_AUTOMATON_STATES];		  // Longest proper suffix of the state that is also a state
+	int16_t output[MAX_AUTOMATON_STATES];	  // First state on the fail chain, the state itself included, that completes a glyph, or -1
+	int16_t glyph[MAX_AUTOMATON_STATES];	  // Glyph whose columns end at this state, or -1
+	uint8_t depth[MAX_AUTOMATON_STATES];	  // Columns from the root
+	uint32_t edge_keys[AUTOMATON_EDGE_SLOTS]; // state << 16 | column word, UINT32_MAX marks an empty slot
+	int16_t edge_targets[AUTOMATON_EDGE_SLOTS];
+} column_automaton;
+
+// A set of glyphs sorted by ASCII code. The glyph arrays point at the compiled-in table, at the owned
+// storage filled from a text glyph file, or into a read-only mapping of a binary glyph-set file.
+typedef struct {
+	const packed_glyph *glyphs;
+	const uint8_t *codes;
+	const uint8_t *widths;
+	const int16_t *index; // Open-addressing index from (width, packed rows) to glyph number, -1 marks an empty slot
+	int count;
+	int gui_scale;
+
+	// Storage for glyphs loaded from a text file and for the index when it is built at startup
+	packed_glyph owned_glyphs[MAX_GLYPHS];
+	uint8_t owned_codes[MAX_GLYPHS];
+	uint8_t owned_widths[MAX_GLYPHS];
+	int16_t owned_index[GLYPH_INDEX_SIZE];
+
+	// Glyph numbers grouped by exact pixel width, and one decision tree per width bucket
+	int bucket_sizes[MATRIX_COLS + 1];
+	int16_t buckets[MATRIX_COLS + 1][MAX_GLYPHS];
+	glyph_tree_node tree_nodes[MAX_TREE_NODES];
+	int tree_node_count;
+	int tree_roots[MATRIX_COLS + 1];
+
+	// Automaton over the glyphs' column words, splits and recognizes whole ink runs
+	column_automaton automaton;
+} glyph_set;
+
+// Binarized image, one bit per pixel: bit N of byte B in a row is pixel 8 * B + N. Bits past the width are 0.
+typedef struct {
+	uint8_t *bits;
+	int width;
+	int height;
+	int stride; // Bytes per row, a multiple of PLANE_ALIGN
+} bit_plane;
+
+// Rectangle of a bit plane read in place: pixel (x, y) of the view is pixel (x0 + x, y0 + y) of the plane
+typedef struct {
+	const uint8_t *bits; // First row of the plane
+	int stride;
+	int x0;
+	int y0;
+	int width;
+	int height;
+} plane_view;
+
+// Rectangle of a frame holding one F3 panel, in frame pixels
+typedef struct {
+	int x;
+	int y;
+	int width;
+	int height;
+} panel_roi;
+
+// Text lines of a frame, found from its row projection
+typedef struct {
+	int origin; // Row of the first line's top glyph row
+	int count;	// Lines down to the last one with text in either column
+	uint8_t *ink; // Per line: bit 0 set when the left column has text on it, bit 1 the right column
+} line_grid;
+
+// Header of a binary glyph-set file (little-endian). The sections follow at the given offsets:
+// packed_glyph[glyph_count], uint8_t codes[glyph_count], uint8_t widths[glyph_count], int16_t index[index_size].
+typedef struct {
+	char magic[4];
+	uint16_t version;
+	uint16_t gui_scale;
+	uint16_t glyph_count;
+	uint16_t row_width; // Bits per packed row
+	uint16_t matrix_rows;
+	uint16_t index_size;
+	uint32_t glyphs_offset;
+	uint32_t codes_offset;
+	uint32_t widths_offset;
+	uint32_t index_offset;
+} glyph_set_header;
+
+// Glyph compare kernel, selected once at startup by select_kernels
+bool glyphs_equal_scalar(const packed_glyph *a, const packed_glyph *b);
+bool (*glyphs_equal)(const packed_glyph *a, const packed_glyph *b) = glyphs_equal_scalar;
+
+// Glyph Hamming distance kernel, selected once at startup by select_kernels
+int glyph_distance_scalar(const packed_glyph *a, const packed_glyph *b);
+int (*glyph_distance)(const packed_glyph *a, const packed_glyph *b) = glyph_distance_scalar;
+
+// Row binarization kernel, selected once at startup by select_kernels
+void binarize_row_scalar(const unsigned char *src, int width, int channels, uint8_t *dst);
+void (*binarize_row)(const unsigned char *src, int width, int channels, uint8_t *dst) = binarize_row_scalar;
+
+// Largest Hamming distance accepted for a nearest-glyph match when no glyph matches exactly
+int max_glyph_distance = DEFAULT_MAX_DISTANCE;
+
+// Left and right panel regions: when set, only these rectangles of a frame are binarized. They come from --roi
+// or are learned from a whole frame, and are learned again when text reaches their edges or the resolution changes.
+panel_roi panel_rois[2];
+bool panel_rois_set = false;
+bool learn_panel_rois = false;
+
+// Segment text lines from a column-major copy, one MATRIX_ROWS-bit word per column, instead of the row-major plane
+bool column_major_lines = false;
+
+// Split and recognize ink runs with the glyph set's column automaton before falling back to the classifier
+bool use_column_automaton = false;
+
+// Fields --fields can ask for, each found on the F3 line that starts with its label
+typedef struct {
+	const char *name;  // As in dataset records
+	const char *label; // NULL for the dimension line, which starts with a namespaced id followed by a space
+	bool name_follows; // The field's name is alone on the next line
+} field_label;
+
+const field_label field_labels[] = {
+	{"xyz", "XYZ: ", false},
+	{"block", "Block: ", false},
+	{"chunk", "Chunk: ", false},
+	{"facing", "Facing: ", false},
+	{"light", "Client Light: ", false},
+	{"biome", "Biome: ", false},
+	{"dimension", NULL, false},
+	{"targeted_block", "Targeted Block: ", true},
+	{"targeted_fluid", "Targeted Fluid: ", true},
+};
+
+#define FIELD_LABEL_COUNT (int)(sizeof(field_labels) / sizeof(field_labels[0]))
+
+// Bit per field_labels entry. Lines of the fields that were not asked for are cut off as soon as their first glyphs
+// rule out every requested label, and come out empty; 0 recognizes every line.
+uint32_t requested_fields = 0;
+
+// Growable text buffer
+typedef struct {
+	char *data;
+	size_t length;
+	size_t capacity;
+} text_buffer;
+
+// Text and confidence digits of the frame being recognized, written out with one write per file once it is done
+text_buffer frame_text = {NULL, 0, 0};
+text_buffer frame_confidence = {NULL, 0, 0};
+
+// Text and confidence digits of the line being recognized, and whether it has a character no glyph matched
+text_buffer line_text = {NULL, 0, 0};
+text_buffer line_confidence = {NULL, 0, 0};
+bool line_has_unknown = false;
+
+// Glyphs matched in the frame being recognized and how many of them no glyph matched, lines taken from the cache or the previous frame are not counted
+int frame_glyphs = 0;
+int frame_unknown_glyphs = 0;
+
+// Whether the line being recognized is wanted with --fields, decided from its first glyphs
+typedef enum {
+	LINE_UNDECIDED,
+	LINE_SELECTED,
+	LINE_SKIPPED,
+} line_selection;
+
+line_selection current_line_selection = LINE_SELECTED;
+bool line_name_follows = false; // The selected line's field name is on the next line
+
+// Recently recognized line bitmaps with their text, so lines that stay the same across frames are only hashed
+typedef struct {
+	uint64_t hash; // Of the cropped line bitmap, its size and the profile; 0 marks an empty entry
+	uint32_t last_used;
+	text_buffer text;
+	text_buffer confidence;
+} cached_line;
+
+cached_line line_cache[LINE_CACHE_SETS][LINE_CACHE_WAYS];
+uint32_t line_cache_clock = 0;
+
+// Direction the player faces, from the Facing line
+typedef enum {
+	FACING_UNKNOWN,
+	FACING_NORTH,
+	FACING_SOUTH,
+	FACING_EAST,
+	FACING_WEST,
+} facing_direction;
+
+const char *facing_names[] = {"unknown", "north", "south", "east", "west"};
+
+// Typed fields of one F3 frame. The has_ flags tell which lines were found and parsed; names are interned, so they
+// stay valid for the whole run and equal names share one pointer.
+typedef struct {
+	bool has_position; // XYZ: x / y / z
+	double x, y, z;
+	bool has_block; // Block: x y z
+	int block_x, block_y, block_z;
+	bool has_chunk; // Chunk: x y z, the chunk section
+	int chunk_x, chunk_y, chunk_z;
+	bool has_facing; // Facing: direction (...) (yaw / pitch)
+	facing_direction facing;
+	double yaw, pitch;
+	bool has_light; // Client Light: total (sky sky, block block)
+	int light, sky_light, block_light;
+	const char *biome;	   // Biome: name
+	const char *dimension; // name FC: n
+	bool has_targeted_block; // Targeted Block: x, y, z and the block name on the next line
+	int targeted_block_x, targeted_block_y, targeted_block_z;
+	const char *targeted_block;
+	bool has_targeted_fluid; // Targeted Fluid: x, y, z and the fluid name on the next line
+	int targeted_fluid_x, targeted_fluid_y, targeted_fluid_z;
+	const char *targeted_fluid;
+	bool names_dropped; // A name was read but not kept, the interned names are full; its field is NULL
+} f3_fields;
+
+// Fields of the frame being recognized
+f3_fields frame_fields;
+
+// Interned names: NUL-terminated copies in blocks that never move, numbered from 1 in the order they were interned
+// and found through an open-addressing table of ids (0 marks an empty slot)
+char **intern_blocks = NULL;
+int intern_block_count = 0;
+size_t intern_block_used = INTERN_BLOCK_SIZE; // Bytes used in the last block
+const char **intern_names = NULL;			  // By id, intern_names[0] is unused
+int intern_names_capacity = 0;
+int intern_count = 0;
+uint32_t *intern_slots = NULL;
+int intern_slot_count = 0; // Power of two, kept at least twice the count
+bool intern_full = false;  // A name could not be interned, warned about once
+
+// Dataset file every frame is appended to as one JSON line with --dataset, NULL when each frame gets its own .txt
+FILE *dataset_file = NULL;
+text_buffer dataset_record = {NULL, 0, 0};
+uint64_t dataset_length = 0;		 // Bytes of complete records, a failed write is cut back to it
+bool dataset_needs_newline = false; // The file ends in an unfinished line, the next record starts a new one
+bool dataset_stopped = false;		 // A failed write could not be cut back, nothing more is appended
+
+// Source file names already in the dataset, open addressing over owned copies, NULL marks an empty slot
+char **dataset_sources = NULL;
+int dataset_source_count = 0;
+int dataset_source_capacity = 0; // Power of two, kept at least twice the count
+
+// One frame as written to the columnar dataset with --columns, each member is one column file of the same name.
+// Fields that were not found are 0, the fields member tells which were.
+typedef struct {
+	int64_t timestamp;
+	char source[SOURCE_COLUMN_SIZE];
+	uint8_t fields; // F3_HAS_* bits
+	double x, y, z;
+	float yaw, pitch;
+	int32_t block_x, block_y, block_z;
+	int32_t chunk_x, chunk_y, chunk_z;
+	uint8_t facing;
+	uint8_t light, sky_light, block_light;
+	uint16_t biome, dimension; // Name ids
+	int32_t targeted_block_x, targeted_block_y, targeted_block_z;
+	uint16_t targeted_block;
+	int32_t targeted_fluid_x, targeted_fluid_y, targeted_fluid_z;
+	uint16_t targeted_fluid;
+} column_record;
+
+// Column file layout of one column_record member
+typedef struct {
+	const char *name;
+	f3_column_type type;
+	size_t offset;
+	uint32_t size;
+} column_descriptor;
+
+#define RECORD_COLUMN(member, type) {#member, type, offsetof(column_record, member), sizeof(((column_record *)0)->member)}
+
+const column_descriptor record_columns[] = {
+	RECORD_COLUMN(timestamp, F3_COLUMN_I64),
+	RECORD_COLUMN(source, F3_COLUMN_BYTES),
+	RECORD_COLUMN(fields, F3_COLUMN_U8),
+	RECORD_COLUMN(x, F3_COLUMN_F64),
+	RECORD_COLUMN(y, F3_COLUMN_F64),
+	RECORD_COLUMN(z, F3_COLUMN_F64),
+	RECORD_COLUMN(yaw, F3_COLUMN_F32),
+	RECORD_COLUMN(pitch, F3_COLUMN_F32),
+	RECORD_COLUMN(block_x, F3_COLUMN_I32),
+	RECORD_COLUMN(block_y, F3_COLUMN_I32),
+	RECORD_COLUMN(block_z, F3_COLUMN_I32),
+	RECORD_COLUMN(chunk_x, F3_COLUMN_I32),
+	RECORD_COLUMN(chunk_y, F3_COLUMN_I32),
+	RECORD_COLUMN(chunk_z, F3_COLUMN_I32),
+	RECORD_COLUMN(facing, F3_COLUMN_U8),
+	RECORD_COLUMN(light, F3_COLUMN_U8),
+	RECORD_COLUMN(sky_light, F3_COLUMN_U8),
+	RECORD_COLUMN(block_light, F3_COLUMN_U8),
+	RECORD_COLUMN(biome, F3_COLUMN_U16),
+	RECORD_COLUMN(dimension, F3_COLUMN_U16),
+	RECORD_COLUMN(targeted_block_x, F3_COLUMN_I32),
+	RECORD_COLUMN(targeted_block_y, F3_COLUMN_I32),
+	RECORD_COLUMN(targeted_block_z, F3_COLUMN_I32),
+	RECORD_COLUMN(targeted_block, F3_COLUMN_U16),
+	RECORD_COLUMN(targeted_fluid_x, F3_COLUMN_I32),
+	RECORD_COLUMN(targeted_fluid_y, F3_COLUMN_I32),
+	RECORD_COLUMN(targeted_fluid_z, F3_COLUMN_I32),
+	RECORD_COLUMN(targeted_fluid, F3_COLUMN_U16),
+};
+
+#define COLUMN_COUNT (int)(sizeof(record_columns) / sizeof(record_columns[0]))
+
+// Open column files with --columns, empty when there is no columnar output
+const char *columns_folder = NULL;
+FILE *column_files[COLUMN_COUNT];
+FILE *column_names_file = NULL;
+uint64_t column_frames = 0;	   // Frames committed to every column file
+int column_names_written = 0; // Names with ids up to this are in names.txt
+
+// Confidence output of the frame being processed, empty when --confidence is not given
+char confidence_filepath[512] = "";
+
+// Where the character being matched comes from, recorded with harvested unknown glyphs
+typedef struct {
+	const char *source; // Screenshot file name
+	const char *side;	// "left" or "right" F3 column
+	int line;			// Text line within the column, from 1
+	int line_x;			// Column pixel where the cropped line starts
+	int x;				// Column pixel where the character starts
+} glyph_location;
+
+glyph_location current_location = {"", "", 0, 0, 0};
+
+// One distinct unknown glyph with how often it was seen and where
+typedef struct {
+	packed_glyph glyph;
+	int width;
+	const glyph_set *set;
+	int count;
+	int sample_count;
+	char samples[UNKNOWN_SAMPLES][128];
+} unknown_glyph;
+
+// Deduplicated unknown glyphs of this run, keyed by glyph set, width and packed bitmap; written out at the end
+unknown_glyph *unknown_glyphs = NULL;
+int unknown_glyph_count = 0;
+int unknown_glyph_capacity = 0;
+int *unknown_glyph_index = NULL; // Open addressing over unknown_glyphs, -1 marks an empty slot
+int unknown_glyph_index_size = 0;
+int unknown_glyphs_too_wide = 0; // Unknown inputs wider than MATRIX_COLS, usually touching characters
+
+// Unknown glyph seen in the frame being recognized, with where it was seen
+typedef struct {
+	packed_glyph glyph;
+	int width;
+	const glyph_set *set;
+	char sample[128];
+} pending_glyph;
+
+// Unknown glyphs of the frame being recognized, added to unknown_glyphs only once the frame is accepted, so a pass
+// that is redone with another profile leaves nothing behind
+pending_glyph *pending_glyphs = NULL;
+int pending_glyph_count = 0;
+int pending_glyph_capacity = 0;
+int pending_glyphs_too_wide = 0;
+
+#if ASCII_TABLE_ROWS != MATRIX_ROWS || ASCII_TABLE_COLS != MATRIX_COLS
+#error "headers/ascii_table.h is out of date, rebuild it with generate_ascii_table"
+#endif
+
+// Built-in ASCII character matrices, generated from ascii_base.txt at build time
+const packed_glyph builtin_ascii_matrices[ASCII_TABLE_COUNT] = {ASCII_TABLE_MATRICES};
+const uint8_t builtin_ascii_codes[ASCII_TABLE_COUNT] = {ASCII_TABLE_CODES};
+const uint8_t builtin_ascii_matrix_widths[ASCII_TABLE_COUNT] = {ASCII_TABLE_WIDTHS};
+
+// Glyph sets of the default font as drawn at GUI scale 1 and 2 (index 0 unused); one is loaded, the other derived from it
+glyph_set default_font_glyphs[3];
+
+// Screen layout of the F3 text for one GUI scale and font
+typedef struct {
+	const char *name;
+	int gui_scale;	   // Screen pixels per font pixel
+	int sample_step;   // Screen pixels per glyph-set pixel, 1 when the glyph set is drawn at this scale
+	int top_margin;	   // Rows above the first text line
+	int line_pitch;	   // Rows from one text line to the next
+	int glyph_top;	   // Rows between the top of a line and the top of its glyphs
+	int glyph_rows;	   // Rows of glyph pixels per line
+	int space_columns; // Blank columns that make a space
+	glyph_set *glyphs;
+} glyph_profile;
+
+// GUI scales 3 and 4 are sampled down to the GUI scale 1 and 2 glyph sets, since font pixels are square blocks
+glyph_profile profiles[] = {
+	{"scale1", 1, 1, 1, 9, 1, 8, 4, &default_font_glyphs[1]},
+	{"scale2", 2, 1, 2, 18, 2, 16, 8, &default_font_glyphs[2]},
+	{"scale3", 3, 3, 3, 27, 3, 24, 12, &default_font_glyphs[1]},
+	{"scale4", 4, 2, 4, 36, 4, 32, 16, &default_font_glyphs[2]},
+};
+#define PROFILE_COUNT ((int)(sizeof(profiles) / sizeof(profiles[0])))
+
+// Profile of the frame being processed, chosen on the command line or detected from the first frame
+const glyph_profile *active_profile = NULL;
+
+// Binarized frame with the text of each line per column, kept so the next frame only recognizes the lines that changed.
+// An empty text buffer marks a line that was blank or had an unknown glyph.
+typedef struct {
+	bit_plane plane; // bits is NULL when there is no frame
+	const glyph_profile *profile;
+	int origin; // Row of the first line's top glyph row
+	int line_count;
+	int line_capacity;
+	text_buffer *text[2]; // Left and right column
+	text_buffer *confidence[2];
+} frame_lines;
+
+frame_lines current_frame, previous_frame;
+
+// Function to compare all rows of two packed glyphs, portable version
+bool glyphs_equal_scalar(const packed_glyph *a, const packed_glyph *b) {
+	uint64_t diff = 0;
+	for (int word = 0; word < GLYPH_WORDS; word++) {
+		diff |= a->words[word] ^ b->words[word];
+	}
+	return diff == 0;
+}
+
+// Function to count the differing pixels of two packed glyphs, portable version
+int glyph_distance_scalar(const packed_glyph *a, const packed_glyph *b) {
+	int distance = 0;
+	for (int word = 0; word < GLYPH_WORDS; word++) {
+		distance += __builtin_popcountll(a->words[word] ^ b->words[word]);
+	}
+	return distance;
+}
+
+#ifdef HAVE_X86_KERNELS
+// Function to count the differing pixels of two packed glyphs with the POPCNT instruction
+__attribute__((target("popcnt"))) int glyph_distance_popcnt(const packed_glyph *a, const packed_glyph *b) {
+	int distance = 0;
+	for (int word = 0; word < GLYPH_WORDS; word++) {
+		distance += __builtin_popcountll(a->words[word] ^ b->words[word]);
+	}
+	return distance;
+}
+
+// Function to count the differing pixels of two packed glyphs in one AVX2 pass (nibble lookup popcount)
+__attribute__((target("avx2"))) int glyph_distance_avx2(const packed_glyph *a, const packed_glyph *b) {
+	const __m256i nibble_counts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+	__m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)a->rows), _mm256_loadu_si256((const __m256i *)b->rows));
+	__m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(nibble_counts, _mm256_and_si256(diff, low_nibbles)),
+									 _mm256_shuffle_epi8(nibble_counts, _mm256_and_si256(_mm256_srli_epi16(diff, 4), low_nibbles)));
+	__m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+	__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+	return _mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4);
+}
+
+// Function to compare all rows of two packed glyphs, 8 rows per SSE2 register
+__attribute__((target("sse2"))) bool glyphs_equal_sse2(const packed_glyph *a, const packed_glyph *b) {
+	__m128i low = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)a->rows), _mm_loadu_si128((const __m128i *)b->rows));
+	__m128i high = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a->rows + 8)), _mm_loadu_si128((const __m128i *)(b->rows + 8)));
+	return _mm_movemask_epi8(_mm_and_si128(low, high)) == 0xFFFF;
+}
+
+// Function to compare all 16 rows of two packed glyphs in a single AVX2 register
+__attribute__((target("avx2"))) bool glyphs_equal_avx2(const packed_glyph *a, const packed_glyph *b) {
+	__m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)a->rows), _mm256_loadu_si256((const __m256i *)b->rows));
+	return _mm256_testz_si256(diff, diff);
+}
+#endif
+
+// Function to binarize pixels x..width-1 of one RGB(A) row into a cleared bit plane row
+static inline void binarize_pixels(const unsigned char *src, int x, int width, int channels, uint8_t *dst) {
+	for (src += (size_t)x * channels; x < width; x++, src += channels) {
+		if (src[0] == 221 && src[1] == 221 && src[2] == 221) {
+			dst[x >> 3] |= (uint8_t)(1u << (x & 7));
+		}
+	}
+}
+
+// Function to binarize one RGB(A) row into a cleared bit plane row, portable reference version
+void binarize_row_scalar(const unsigned char *src, int width, int channels, uint8_t *dst) {
+	binarize_pixels(src, 0, width, channels, dst);
+}
+
+#ifdef HAVE_X86_KERNELS
+// Function to binarize one RGB(A) row 32 pixels at a time with SSSE3: each group of 4 pixels is spread to one
+// 32-bit lane with the alpha byte cleared, compared against the colour key and collected with movemask
+__attribute__((target("ssse3"))) void binarize_row_ssse3(const unsigned char *src, int width, int channels, uint8_t *dst) {
+	if (channels != 3 && channels != 4) {
+		binarize_pixels(src, 0, width, channels, dst);
+		return;
+	}
+
+	const __m128i key = _mm_set1_epi32(0x00DDDDDD);
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+	const __m128i spread_rgb = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	int x = 0;
+	for (; x + 32 <= width; x += 32) {
+		const unsigned char *block = src + (size_t)x * channels;
+		uint32_t mask = 0;
+		for (int group = 0; group < 8; group += 4) {
+			__m128i pixels[4];
+			if (channels == 4) {
+				for (int i = 0; i < 4; i++) {
+					pixels[i] = _mm_and_si128(_mm_loadu_si128((const __m128i *)(block + 16 * (group + i))), rgb_mask);
+				}
+			} else {
+				// 16 RGB pixels are exactly three registers, realign each 12-byte group of 4 pixels to lane 0
+				const unsigned char *rgb = block + 12 * group;
+				__m128i a = _mm_loadu_si128((const __m128i *)rgb);
+				__m128i b = _mm_loadu_si128((const __m128i *)(rgb + 16));
+				__m128i c = _mm_loadu_si128((const __m128i *)(rgb + 32));
+				pixels[0] = _mm_shuffle_epi8(a, spread_rgb);
+				pixels[1] = _mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), spread_rgb);
+				pixels[2] = _mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), spread_rgb);
+				pixels[3] = _mm_shuffle_epi8(_mm_srli_si128(c, 4), spread_rgb);
+			}
+			for (int i = 0; i < 4; i++) {
+				uint32_t bits = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(pixels[i], key)));
+				mask |= bits << (4 * (group + i));
+			}
+		}
+		memcpy(dst + (x >> 3), &mask, sizeof(mask));
+	}
+	binarize_pixels(src, x, width, channels, dst);
+}
+
+// Function to binarize one RGB(A) row 32 pixels at a time with AVX2, 8 pixels per register
+__attribute__((target("avx2"))) void binarize_row_avx2(const unsigned char *src, int width, int channels, uint8_t *dst) {
+	if (channels != 3 && channels != 4) {
+		binarize_pixels(src, 0, width, channels, dst);
+		return;
+	}
+
+	const __m256i key = _mm256_set1_epi32(0x00DDDDDD);
+	const __m256i rgb_mask = _mm256_set1_epi32(0x00FFFFFF);
+	// 8 RGB pixels are 6 dwords: the masked load never touches bytes past them, the permute puts pixels 0-3 in the
+	// low lane and 4-7 in the high lane, and the shuffle spreads each lane to one pixel per 32-bit element
+	const __m256i load_rgb = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+	const __m256i split_lanes = _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5);
+	const __m256i spread_rgb = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	int x = 0;
+	for (; x + 32 <= width; x += 32) {
+		const unsigned char *block = src + (size_t)x * channels;
+		uint32_t mask = 0;
+		for (int group = 0; group < 4; group++) {
+			__m256i pixels;
+			if (channels == 4) {
+				pixels = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(block + 32 * group)), rgb_mask);
+			} else {
+				pixels = _mm256_maskload_epi32((const int *)(block + 24 * group), load_rgb);
+				pixels = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(pixels, split_lanes), spread_rgb);
+			}
+			uint32_t bits = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(pixels, key)));
+			mask |= bits << (8 * group);
+		}
+		memcpy(dst + (x >> 3), &mask, sizeof(mask));
+	}
+	binarize_pixels(src, x, width, channels, dst);
+}
+#endif
+
+// Function to pick the fastest glyph and binarization kernels the CPU supports
+void select_kernels(void) {
+#ifdef HAVE_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		glyphs_equal = glyphs_equal_avx2;
+		glyph_distance = glyph_distance_avx2;
+		binarize_row = binarize_row_avx2;
+	} else if (__builtin_cpu_supports("sse2")) {
+		glyphs_equal = glyphs_equal_sse2;
+	}
+	if (glyph_distance == glyph_distance_scalar && __builtin_cpu_supports("popcnt")) {
+		glyph_distance = glyph_distance_popcnt;
+	}
+	if (binarize_row == binarize_row_scalar && __builtin_cpu_supports("ssse3")) {
+		binarize_row = binarize_row_ssse3;
+	}
+#endif
+}
+
+// Function to hash a packed glyph together with its width
+uint32_t hash_glyph(const packed_glyph *glyph, int width) {
+	uint64_t hash = (uint64_t)width * 0x9E3779B97F4A7C15ULL;
+	for (int word = 0; word < GLYPH_WORDS; word++) {
+		hash = (hash ^ glyph->words[word]) * 0xFF51AFD7ED558CCDULL;
+	}
+	return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Function to read one pixel of a packed glyph
+int glyph_pixel(const packed_glyph *glyph, int row, int col) {
+	return (glyph->rows[row] >> col) & 1;
+}
+
+// Function to recursively build a decision tree over a set of same-width glyphs, returns the node index
+int build_glyph_tree(glyph_set *set, int16_t *glyphs, int count, int width) {
+	int node = set->tree_node_count++;
+
+	// Pick the pixel that splits the set most evenly, so every probe discards about half the candidates
+	int best_row = -1, best_col = -1, best_score = count;
+	for (int row = 0; row < MATRIX_ROWS; row++) {
+		for (int col = 0; col < width; col++) {
+			int ones = 0;
+			for (int i = 0; i < count; i++) {
+				ones += glyph_pixel(&set->glyphs[glyphs[i]], row, col);
+			}
+			if (ones == 0 || ones == count)
+				continue; // Pixel does not discriminate within this set
+
+			int score = abs(2 * ones - count);
+			if (score < best_score) {
+				best_score = score;
+				best_row = row;
+				best_col = col;
+			}
+		}
+	}
+
+	set->tree_nodes[node].row = (int8_t)best_row;
+	set->tree_nodes[node].col = (int8_t)best_col;
+	set->tree_nodes[node].glyph = glyphs[0];
+	if (best_row < 0) {
+		return node; // Single glyph (or identical bitmaps, lowest ASCII code wins)
+	}
+
+	// Partition in place: glyphs without the pixel first, keeping ascending ASCII order on both sides
+	int16_t zeros[MAX_GLYPHS], ones[MAX_GLYPHS];
+	int zero_count = 0, one_count = 0;
+	for (int i = 0; i < count; i++) {
+		if (glyph_pixel(&set->glyphs[glyphs[i]], best_row, best_col)) {
+			ones[one_count++] = glyphs[i];
+		} else {
+			zeros[zero_count++] = glyphs[i];
+		}
+	}
+	memcpy(glyphs, zeros, zero_count * sizeof(int16_t));
+	memcpy(glyphs + zero_count, ones, one_count * sizeof(int16_t));
+
+	int child_zero = build_glyph_tree(set, glyphs, zero_count, width);
+	int child_one = build_glyph_tree(set, glyphs + zero_count, one_count, width);
+	set->tree_nodes[node].children[0] = (int16_t)child_zero;
+	set->tree_nodes[node].children[1] = (int16_t)child_one;
+	return node;
+}
+
+// Function to build one decision tree per width bucket
+void build_glyph_trees(glyph_set *set) {
+	set->tree_node_count = 0;
+	for (int width = 0; width <= MATRIX_COLS; width++) {
+		set->tree_roots[width] = -1;
+		if (set->bucket_sizes[width] == 0)
+			continue;
 
-const int row_height = 18;
+		int16_t glyphs[MAX_GLYPHS];
+		memcpy(glyphs, set->buckets[width], set->bucket_sizes[width] * sizeof(int16_t));
+		set->tree_roots[width] = build_glyph_tree(set, glyphs, set->bucket_sizes[width], width);
+	}
+}
+
+// Function to walk the decision tree of a width bucket down to its only remaining candidate, returns -1 if the bucket is empty
+int find_glyph_by_tree(const glyph_set *set, const packed_glyph *character, int char_width) {
+	if (char_width > MATRIX_COLS || set->tree_roots[char_width] < 0)
+		return -1;
+
+	const glyph_tree_node *node = &set->tree_nodes[set->tree_roots[char_width]];
+	while (node->row >= 0) {
+		node = &set->tree_nodes[node->children[glyph_pixel(character, node->row, node->col)]];
+	}
+	return node->glyph;
+}
+
+// Function to find the edge of an automaton state on a column word, returns the target state or -1
+static inline int automaton_edge(const column_automaton *automaton, int state, uint16_t word) {
+	uint32_t key = (uint32_t)state << 16 | word;
+	uint32_t slot = (key * 0x9E3779B1u) >> 20 & (AUTOMATON_EDGE_SLOTS - 1);
+	while (automaton->edge_keys[slot] != UINT32_MAX) {
+		if (automaton->edge_keys[slot] == key) {
+			return automaton->edge_targets[slot];
+		}
+		slot = (slot + 1) & (AUTOMATON_EDGE_SLOTS - 1);
+	}
+	return -1;
+}
+
+// Function to follow a column word from an automaton state, falling back along the fail links
+static inline int automaton_step(const column_automaton *automaton, int state, uint16_t word) {
+	for (;;) {
+		int next = automaton_edge(automaton, state, word);
+		if (next >= 0)
+			return next;
+		if (state == 0)
+			return 0;
+		state = automaton->fail[state];
+	}
+}
+
+// Function to get the ink columns of a glyph as column words (bit Y is row Y), without the blank border columns.
+// Returns the number of columns, or 0 when the glyph is blank or has a blank column inside, which no ink run can hold.
+int glyph_ink_columns(const packed_glyph *glyph, int width, uint16_t *columns) {
+	int count = 0, first = -1;
+	for (int col = 0; col < width; col++) {
+		uint16_t word = 0;
+		for (int row = 0; row < MATRIX_ROWS; row++) {
+			word |= (uint16_t)(glyph_pixel(glyph, row, col) << row);
+		}
+		if (word && first < 0) {
+			first = col;
+		}
+		if (first >= 0) {
+			columns[count++] = word;
+		}
+	}
+	while (count > 0 && columns[count - 1] == 0) {
+		count--;
+	}
+	for (int col = 0; col < count; col++) {
+		if (columns[col] == 0)
+			return 0;
+	}
+	return count;
+}
+
+// Function to build the column automaton of a glyph set: a trie of the glyphs' ink columns, then fail links
+// set in order of depth, so each state's fail chain is complete before its children need it
+void build_column_automaton(glyph_set *set) {
+	column_automaton *automaton = &set->automaton;
+	static int16_t parents[MAX_AUTOMATON_STATES];
+	static uint16_t words[MAX_AUTOMATON_STATES];
+
+	memset(automaton->edge_keys, 0xFF, sizeof(automaton->edge_keys));
+	automaton->state_count = 1;
+	automaton->fail[0] = 0;
+	automaton->glyph[0] = -1;
+	automaton->depth[0] = 0;
+
+	for (int glyph = 0; glyph < set->count; glyph++) {
+		uint16_t columns[MATRIX_COLS];
+		int count = glyph_ink_columns(&set->glyphs[glyph], set->widths[glyph], columns);
+		int state = 0;
+		for (int col = 0; col < count; col++) {
+			int next = automaton_edge(automaton, state, columns[col]);
+			if (next < 0) {
+				next = automaton->state_count++;
+				automaton->glyph[next] = -1;
+				automaton->depth[next] = (uint8_t)(col + 1);
+				parents[next] = (int16_t)state;
+				words[next] = columns[col];
+
+				uint32_t key = (uint32_t)state << 16 | columns[col];
+				uint32_t slot = (key * 0x9E3779B1u) >> 20 & (AUTOMATON_EDGE_SLOTS - 1);
+				while (automaton->edge_keys[slot] != UINT32_MAX) {
+					slot = (slot + 1) & (AUTOMATON_EDGE_SLOTS - 1);
+				}
+				automaton->edge_keys[slot] = key;
+				automaton->edge_targets[slot] = (int16_t)next;
+			}
+			state = next;
+		}
+		if (count > 0 && automaton->glyph[state] < 0) {
+			automaton->glyph[state] = (int16_t)glyph; // Duplicate columns keep the lower ASCII code
+		}
+	}
+
+	automaton->output[0] = -1;
+	for (int depth = 1; depth <= MATRIX_COLS; depth++) {
+		for (int state = 1; state < automaton->state_count; state++) {
+			if (automaton->depth[state] != depth)
+				continue;
+
+			int fail = 0;
+			if (depth > 1) {
+				fail = automaton_step(automaton, automaton->fail[parents[state]], words[state]);
+			}
+			automaton->fail[state] = (int16_t)fail;
+			automaton->output[state] = automaton->glyph[state] >= 0 ? (int16_t)state : automaton->output[fail];
+		}
+	}
+}
+
+// Function to split an ink run of column words into known glyphs in one pass of the column automaton. Every glyph
+// ending at a column extends the cheapest split of the columns before it, so touching glyphs come apart too.
+// Returns the number of glyphs, with their numbers and first columns, or 0 if the run is not made of known glyphs.
+int parse_ink_run(const column_automaton *automaton, const uint16_t *columns, int count, int16_t *glyphs, int16_t *starts) {
+	int16_t splits[MAX_RUN_COLUMNS + 1]; // Fewest glyphs covering the first N columns, -1 if they cannot be covered
+	int16_t last_state[MAX_RUN_COLUMNS + 1];
+	if (count <= 0 || count > MAX_RUN_COLUMNS)
+		return 0;
+
+	splits[0] = 0;
+	int state = 0;
+	for (int col = 0; col < count; col++) {
+		splits[col + 1] = -1;
+		state = automaton_step(automaton, state, columns[col]);
+		for (int match = automaton->output[state]; match >= 0; match = automaton->output[automaton->fail[match]]) {
+			int begin = col + 1 - automaton->depth[match];
+			if (splits[begin] >= 0 && (splits[col + 1] < 0 || splits[begin] + 1 < splits[col + 1])) {
+				splits[col + 1] = (int16_t)(splits[begin] + 1);
+				last_state[col + 1] = (int16_t)match;
+			}
+		}
+	}
+	if (splits[count] < 0)
+		return 0;
+
+	// Walk the cheapest split back from the end
+	int glyph_count = splits[count];
+	for (int end = count, i = glyph_count - 1; end > 0; i--) {
+		int match = last_state[end];
+		glyphs[i] = automaton->glyph[match];
+		starts[i] = (int16_t)(end - automaton->depth[match]);
+		end = starts[i];
+	}
+	return glyph_count;
+}
+
+// Function to build the width buckets, decision trees and column automaton of a glyph set, and its hash index unless a prebuilt one was mapped
+void build_glyph_index(glyph_set *set) {
+	memset(set->bucket_sizes, 0, sizeof(set->bucket_sizes));
+	for (int glyph = 0; glyph < set->count; glyph++) {
+		int width = set->widths[glyph];
+		set->buckets[width][set->bucket_sizes[width]++] = (int16_t)glyph;
+	}
+	build_glyph_trees(set);
+	build_column_automaton(set);
+
+	if (set->index)
+		return;
+
+	for (int slot = 0; slot < GLYPH_INDEX_SIZE; slot++) {
+		set->owned_index[slot] = -1;
+	}
+	for (int glyph = 0; glyph < set->count; glyph++) {
+		int width = set->widths[glyph];
+		uint32_t slot = hash_glyph(&set->glyphs[glyph], width) & (GLYPH_INDEX_SIZE - 1);
+		for (int probe = 0; probe < GLYPH_INDEX_SIZE && set->owned_index[slot] != -1; probe++) {
+			int other = set->owned_index[slot];
+			if (set->widths[other] == width && glyphs_equal(&set->glyphs[other], &set->glyphs[glyph])) {
+				break; // Duplicate bitmap, keep the lower ASCII code like the linear scan did
+			}
+			slot = (slot + 1) & (GLYPH_INDEX_SIZE - 1);
+		}
+		if (set->owned_index[slot] == -1) {
+			set->owned_index[slot] = (int16_t)glyph;
+		}
+	}
+	set->index = set->owned_index;
+}
+
+// Function to look up an exact (width, bitmap) match in the hash index, returns the glyph number or -1 if there is none
+int find_glyph_by_hash(const glyph_set *set, const packed_glyph *character, int char_width) {
+	if (char_width > MATRIX_COLS)
+		return -1; // Wider than any stored matrix
+
+	// Bounded, so an index without an empty slot cannot make a miss probe forever
+	uint32_t slot = hash_glyph(character, char_width) & (GLYPH_INDEX_SIZE - 1);
+	for (int probe = 0; probe < GLYPH_INDEX_SIZE && set->index[slot] != -1; probe++) {
+		int glyph = set->index[slot];
+		if (set->widths[glyph] == char_width && glyphs_equal(&set->glyphs[glyph], character)) {
+			return glyph;
+		}
+		slot = (slot + 1) & (GLYPH_INDEX_SIZE - 1);
+	}
+	return -1;
+}
 
-// Global storage for ASCII character matrices
-char ascii_matrices[MAX_ASCII][MATRIX_ROWS][MATRIX_COLS + 1] = {{{0}}};
-int ascii_matrix_widths[MAX_ASCII] = {0};
+// Function to use the compiled-in glyph table
+void use_builtin_glyphs(glyph_set *set) {
+	set->glyphs = builtin_ascii_matrices;
+	set->codes = builtin_ascii_codes;
+	set->widths = builtin_ascii_matrix_widths;
+	set->index = NULL;
+	set->count = ASCII_TABLE_COUNT;
+	set->gui_scale = 2;
+}
 
-// Function to load ASCII matrices from file
-void load_ascii_matrices(const char *filename) {
+// Function to load ASCII matrices from a text glyph file in place of the built-in table
+bool load_ascii_matrices(glyph_set *set, const char *filename) {
 	FILE *file = fopen(filename, "r");
 	if (!file) {
 		perror("Error opening file");
-		return;
+		return false;
 	}
 
+	// Collect by ASCII code first, the file does not have to be sorted
+	static packed_glyph matrices[MAX_ASCII];
+	static int matrix_widths[MAX_ASCII];
+	memset(matrices, 0, sizeof(matrices));
+	memset(matrix_widths, 0, sizeof(matrix_widths));
+
 	char line[64];
 	int ascii_code = -1;
 	int row = 0;
@@ -43,314 +974,2130 @@ void load_ascii_matrices(const char *filename) {
 			sscanf(line, "ASCII %d:", &ascii_code);
 			row = 0; // Reset row counter
 		} else if (ascii_code >= 0 && isdigit(line[0])) {
-			if (row < MATRIX_ROWS) {
-				// Copy only up to MATRIX_COLS characters
-				strncpy(ascii_matrices[ascii_code][row], line, MATRIX_COLS);
-				ascii_matrices[ascii_code][row][MATRIX_COLS] = '\0';
+			if (row < MATRIX_ROWS && ascii_code < MAX_ASCII) {
+				// Pack only up to MATRIX_COLS characters
+				uint16_t bits = 0;
+				for (int col = 0; col < MATRIX_COLS && line[col]; col++) {
+					if (line[col] == '1') {
+						bits |= (uint16_t)(1u << col);
+					}
+				}
+				matrices[ascii_code].rows[row] = bits;
 
 				// Update matrix width if needed
 				int width = strlen(line);
-				if (width > ascii_matrix_widths[ascii_code]) {
-					ascii_matrix_widths[ascii_code] = width;
+				if (width > MATRIX_COLS) {
+					width = MATRIX_COLS;
+				}
+				if (width > matrix_widths[ascii_code]) {
+					matrix_widths[ascii_code] = width;
 				}
 				row++;
 			}
 		}
-	}
+	}
+
+	fclose(file);
+
+	set->count = 0;
+	for (int code = 0; code < MAX_ASCII; code++) {
+		if (matrix_widths[code] == 0)
+			continue; // Skip uninitialized matrices
+
+		set->owned_glyphs[set->count] = matrices[code];
+		set->owned_codes[set->count] = (uint8_t)code;
+		set->owned_widths[set->count] = (uint8_t)matrix_widths[code];
+		set->count++;
+	}
+	set->glyphs = set->owned_glyphs;
+	set->codes = set->owned_codes;
+	set->widths = set->owned_widths;
+	set->index = NULL;
+	set->gui_scale = 2; // Text glyph files are captured at GUI scale 2
+	return true;
+}
+
+// Function to redraw one glyph from GUI scale 'from_scale' at 'to_scale' (1 or 2), returns the new width.
+// Glyph pixels are square blocks of the font pixel size and the borders stay 1 pixel wide at every scale.
+int redraw_glyph(const packed_glyph *from, int width, int from_scale, int to_scale, packed_glyph *to) {
+	int ink_width = (width - 2) * to_scale / from_scale;
+	if (ink_width > MATRIX_COLS - 2) {
+		ink_width = MATRIX_COLS - 2;
+	}
+
+	memset(to, 0, sizeof(*to));
+	for (int row = 0; row < MATRIX_ROWS; row++) {
+		int src_row = row * from_scale / to_scale;
+		if (src_row >= MATRIX_ROWS)
+			break;
+
+		for (int col = 0; col < ink_width; col++) {
+			if (glyph_pixel(from, src_row, col * from_scale / to_scale + 1)) {
+				to->rows[row] |= (uint16_t)(1u << (col + 1));
+			}
+		}
+	}
+	return ink_width + 2;
+}
+
+// Function to redraw a glyph set at GUI scale 1 or 2, e.g. to get the GUI scale 1 font from ascii_base.txt
+void derive_glyph_set(glyph_set *dst, const glyph_set *src, int gui_scale) {
+	for (int glyph = 0; glyph < src->count; glyph++) {
+		int width = redraw_glyph(&src->glyphs[glyph], src->widths[glyph], src->gui_scale, gui_scale, &dst->owned_glyphs[glyph]);
+		dst->owned_codes[glyph] = src->codes[glyph];
+		dst->owned_widths[glyph] = (uint8_t)width;
+	}
+
+	dst->glyphs = dst->owned_glyphs;
+	dst->codes = dst->owned_codes;
+	dst->widths = dst->owned_widths;
+	dst->index = NULL;
+	dst->count = src->count;
+	dst->gui_scale = gui_scale;
+}
+
+// Function to map a whole file read-only, returns NULL on failure. The mapping lives until the process exits.
+const unsigned char *map_file_readonly(const char *filename, size_t *size) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	LARGE_INTEGER file_size;
+	HANDLE mapping = NULL;
+	const unsigned char *data = NULL;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (mapping) {
+		data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping); // The view keeps the mapping alive
+	}
+	CloseHandle(file);
+	*size = data ? (size_t)file_size.QuadPart : 0;
+	return data;
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd); // The mapping keeps the file alive
+	if (data == MAP_FAILED)
+		return NULL;
+	*size = (size_t)st.st_size;
+	return (const unsigned char *)data;
+#endif
+}
+
+// Function to check that a section of 'count' elements of 'element_size' bytes lies inside the mapped file
+bool glyph_section_fits(uint32_t offset, size_t count, size_t element_size, size_t file_size) {
+	return offset <= file_size && count * element_size <= file_size - offset;
+}
+
+// Function to check whether a file starts with the binary glyph-set magic
+bool is_glyph_set_file(const char *filename) {
+	char magic[4] = {0};
+	FILE *file = fopen(filename, "rb");
+	if (!file)
+		return false;
+	size_t read = fread(magic, 1, sizeof(magic), file);
+	fclose(file);
+	return read == sizeof(magic) && memcmp(magic, GLYPH_SET_MAGIC, sizeof(magic)) == 0;
+}
+
+// Function to map a binary glyph-set file and point the glyph set straight at its sections
+bool load_glyph_set_file(glyph_set *set, const char *filename) {
+	size_t size = 0;
+	const unsigned char *data = map_file_readonly(filename, &size);
+	if (!data) {
+		printf("Error mapping glyph-set file: %s\n", filename);
+		return false;
+	}
+
+	glyph_set_header header;
+	if (size < sizeof(header)) {
+		printf("Glyph-set file is truncated: %s\n", filename);
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	if (memcmp(header.magic, GLYPH_SET_MAGIC, sizeof(header.magic)) != 0 || header.version != GLYPH_SET_VERSION) {
+		printf("Unsupported glyph-set file (version %d): %s\n", header.version, filename);
+		return false;
+	}
+	if (header.row_width != MATRIX_COLS || header.matrix_rows != MATRIX_ROWS || header.glyph_count > MAX_GLYPHS || header.glyphs_offset % sizeof(uint64_t) != 0 ||
+		header.index_offset % sizeof(int16_t) != 0 || !glyph_section_fits(header.glyphs_offset, header.glyph_count, sizeof(packed_glyph), size) ||
+		!glyph_section_fits(header.codes_offset, header.glyph_count, 1, size) || !glyph_section_fits(header.widths_offset, header.glyph_count, 1, size) ||
+		!glyph_section_fits(header.index_offset, header.index_size, sizeof(int16_t), size)) {
+		printf("Glyph-set file does not match this build: %s\n", filename);
+		return false;
+	}
+
+	set->glyphs = (const packed_glyph *)(data + header.glyphs_offset);
+	set->codes = data + header.codes_offset;
+	set->widths = data + header.widths_offset;
+	set->count = header.glyph_count;
+	set->gui_scale = header.gui_scale;
+	if (set->gui_scale != 1 && set->gui_scale != 2) {
+		printf("Glyph-set file must be drawn at GUI scale 1 or 2: %s\n", filename);
+		return false;
+	}
+	for (int glyph = 0; glyph < set->count; glyph++) {
+		if (set->widths[glyph] == 0 || set->widths[glyph] > MATRIX_COLS) {
+			printf("Glyph-set file has an invalid glyph width: %s\n", filename);
+			return false;
+		}
+	}
+
+	// A prebuilt index is only usable if it was hashed into the same number of slots
+	set->index = (header.index_size == GLYPH_INDEX_SIZE) ? (const int16_t *)(data + header.index_offset) : NULL;
+	bool has_empty_slot = false;
+	for (int slot = 0; set->index && slot < GLYPH_INDEX_SIZE; slot++) {
+		if (set->index[slot] < -1 || set->index[slot] >= set->count) {
+			set->index = NULL; // Corrupt index, rebuild it at startup instead
+		} else {
+			has_empty_slot |= set->index[slot] == -1;
+		}
+	}
+	if (set->index && !has_empty_slot) {
+		set->index = NULL; // Misses would probe every slot
+	}
+
+	// Every glyph must be found where it hashes to, as itself or as the lower-numbered glyph with the same bitmap,
+	// otherwise a stale or reordered index would silently lose exact matches
+	for (int glyph = 0; set->index && glyph < set->count; glyph++) {
+		int found = find_glyph_by_hash(set, &set->glyphs[glyph], set->widths[glyph]);
+		if (found < 0 || found > glyph) {
+			set->index = NULL;
+		}
+	}
+	if (header.index_size == GLYPH_INDEX_SIZE && !set->index) {
+		printf("Glyph-set file has an unusable index, rebuilding it: %s\n", filename);
+	}
+	return true;
+}
+
+// Function to write a glyph set, including its hash index, as a binary glyph-set file
+bool write_glyph_set_file(const glyph_set *set, const char *filename) {
+	FILE *file = fopen(filename, "wb");
+	if (!file) {
+		perror("Error opening glyph-set file");
+		return false;
+	}
+
+	glyph_set_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, GLYPH_SET_MAGIC, sizeof(header.magic));
+	header.version = GLYPH_SET_VERSION;
+	header.gui_scale = (uint16_t)set->gui_scale;
+	header.glyph_count = (uint16_t)set->count;
+	header.row_width = MATRIX_COLS;
+	header.matrix_rows = MATRIX_ROWS;
+	header.index_size = GLYPH_INDEX_SIZE;
+	header.glyphs_offset = 32; // Keeps the bitmaps 32-byte aligned for the vector kernels
+	header.codes_offset = header.glyphs_offset + set->count * sizeof(packed_glyph);
+	header.widths_offset = header.codes_offset + set->count;
+	header.index_offset = (header.widths_offset + set->count + 1) & ~1u;
+
+	static const unsigned char padding[32] = {0};
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && fwrite(padding, 1, header.glyphs_offset - sizeof(header), file) == header.glyphs_offset - sizeof(header);
+	ok = ok && fwrite(set->glyphs, sizeof(packed_glyph), set->count, file) == (size_t)set->count;
+	ok = ok && fwrite(set->codes, 1, set->count, file) == (size_t)set->count;
+	ok = ok && fwrite(set->widths, 1, set->count, file) == (size_t)set->count;
+	ok = ok && fwrite(padding, 1, header.index_offset - header.widths_offset - set->count, file) == header.index_offset - header.widths_offset - set->count;
+	ok = ok && fwrite(set->index, sizeof(int16_t), GLYPH_INDEX_SIZE, file) == GLYPH_INDEX_SIZE;
+
+	if (fclose(file) != 0 || !ok) {
+		printf("Error writing glyph-set file: %s\n", filename);
+		return false;
+	}
+	return true;
+}
+
+// Function to write a given character matrix in the format of ascii_base.txt
+void write_character_matrix(FILE *file, const packed_glyph *character, int char_width) {
+	for (int row = 0; row < MATRIX_ROWS; row++) {
+		for (int col = 0; col < char_width; col++) {
+			fputc((character->rows[row] >> col) & 1 ? '1' : '0', file);
+		}
+		fputc('\n', file);
+	}
+}
+
+// Function to add an unmatched character to the deduplicated set of unknown glyphs
+void add_unknown_glyph(const glyph_set *set, const packed_glyph *character, int char_width, const char *sample) {
+	// Keep the index at most half full
+	if (2 * (unknown_glyph_count + 1) > unknown_glyph_index_size) {
+		int new_size = unknown_glyph_index_size ? 2 * unknown_glyph_index_size : 64;
+		int *new_index = (int *)malloc(new_size * sizeof(int));
+		if (!new_index) {
+			printf("Memory allocation failed for unknown glyph index\n");
+			return;
+		}
+		for (int slot = 0; slot < new_size; slot++) {
+			new_index[slot] = -1;
+		}
+		for (int i = 0; i < unknown_glyph_count; i++) {
+			uint32_t slot = hash_glyph(&unknown_glyphs[i].glyph, unknown_glyphs[i].width) & (new_size - 1);
+			while (new_index[slot] != -1) {
+				slot = (slot + 1) & (new_size - 1);
+			}
+			new_index[slot] = i;
+		}
+		free(unknown_glyph_index);
+		unknown_glyph_index = new_index;
+		unknown_glyph_index_size = new_size;
+	}
+
+	uint32_t slot = hash_glyph(character, char_width) & (unknown_glyph_index_size - 1);
+	while (unknown_glyph_index[slot] != -1) {
+		unknown_glyph *entry = &unknown_glyphs[unknown_glyph_index[slot]];
+		if (entry->set == set && entry->width == char_width && glyphs_equal(&entry->glyph, character))
+			break;
+		slot = (slot + 1) & (unknown_glyph_index_size - 1);
+	}
+
+	if (unknown_glyph_index[slot] == -1) {
+		if (unknown_glyph_count == unknown_glyph_capacity) {
+			int new_capacity = unknown_glyph_capacity ? 2 * unknown_glyph_capacity : 32;
+			unknown_glyph *new_glyphs = (unknown_glyph *)realloc(unknown_glyphs, new_capacity * sizeof(unknown_glyph));
+			if (!new_glyphs) {
+				printf("Memory allocation failed for unknown glyphs\n");
+				return;
+			}
+			unknown_glyphs = new_glyphs;
+			unknown_glyph_capacity = new_capacity;
+		}
+
+		unknown_glyph *entry = &unknown_glyphs[unknown_glyph_count];
+		memset(entry, 0, sizeof(*entry));
+		entry->glyph = *character;
+		entry->width = char_width;
+		entry->set = set;
+		unknown_glyph_index[slot] = unknown_glyph_count++;
+	}
+
+	unknown_glyph *entry = &unknown_glyphs[unknown_glyph_index[slot]];
+	entry->count++;
+	if (entry->sample_count < UNKNOWN_SAMPLES) {
+		snprintf(entry->samples[entry->sample_count++], sizeof(entry->samples[0]), "%s", sample);
+	}
+}
+
+// Function to record an unmatched character of the frame being recognized, until the frame is accepted
+void harvest_unknown_glyph(const glyph_set *set, const packed_glyph *character, int char_width) {
+	if (char_width > MATRIX_COLS) {
+		pending_glyphs_too_wide++;
+		return;
+	}
+
+	if (pending_glyph_count == pending_glyph_capacity) {
+		int new_capacity = pending_glyph_capacity ? 2 * pending_glyph_capacity : 32;
+		pending_glyph *new_glyphs = (pending_glyph *)realloc(pending_glyphs, new_capacity * sizeof(pending_glyph));
+		if (!new_glyphs) {
+			printf("Memory allocation failed for unknown glyphs\n");
+			return;
+		}
+		pending_glyphs = new_glyphs;
+		pending_glyph_capacity = new_capacity;
+	}
+
+	pending_glyph *pending = &pending_glyphs[pending_glyph_count++];
+	pending->glyph = *character;
+	pending->width = char_width;
+	pending->set = set;
+	snprintf(pending->sample, sizeof(pending->sample), "%s %s line %d x %d", current_location.source, current_location.side, current_location.line,
+			 current_location.x);
+}
+
+// Function to add the unknown glyphs of an accepted frame to the run's set, or drop them when the frame is redone
+void settle_pending_glyphs(bool accepted) {
+	for (int i = 0; accepted && i < pending_glyph_count; i++) {
+		add_unknown_glyph(pending_glyphs[i].set, &pending_glyphs[i].glyph, pending_glyphs[i].width, pending_glyphs[i].sample);
+	}
+	if (accepted) {
+		unknown_glyphs_too_wide += pending_glyphs_too_wide;
+	}
+	pending_glyph_count = pending_glyphs_too_wide = 0;
+}
+
+// Function to order unknown glyphs by descending count
+int compare_unknown_glyphs(const void *a, const void *b) {
+	return ((const unknown_glyph *)b)->count - ((const unknown_glyph *)a)->count;
+}
+
+// Function to append the unknown glyphs of this run to UNKNOWN_GLYPHS_FILE, most frequent first, in the
+// format of ascii_base.txt. Default-font glyphs are redrawn at GUI scale 2 so they can be appended as they are.
+void write_unknown_glyphs(void) {
+	if (unknown_glyph_count == 0 && unknown_glyphs_too_wide == 0)
+		return;
+
+	FILE *file = fopen(UNKNOWN_GLYPHS_FILE, "a");
+	if (!file) {
+		perror("Error opening unknown glyphs file");
+		return;
+	}
+
+	qsort(unknown_glyphs, unknown_glyph_count, sizeof(unknown_glyph), compare_unknown_glyphs);
+	free(unknown_glyph_index); // Slots refer to the unsorted order
+	unknown_glyph_index = NULL;
+	unknown_glyph_index_size = 0;
+
+	fprintf(file, "# %d distinct unknown glyphs, %d wider than %d columns skipped. Replace 63 and '?' before appending to the glyph file.\n\n",
+			unknown_glyph_count, unknown_glyphs_too_wide, MATRIX_COLS);
+	for (int i = 0; i < unknown_glyph_count; i++) {
+		unknown_glyph *entry = &unknown_glyphs[i];
+		packed_glyph glyph = entry->glyph;
+		int width = entry->width;
+		if (entry->set->gui_scale != 2) {
+			width = redraw_glyph(&entry->glyph, entry->width, entry->set->gui_scale, 2, &glyph);
+		}
+
+		fprintf(file, "# Seen %d times, e.g. at", entry->count);
+		for (int sample = 0; sample < entry->sample_count; sample++) {
+			fprintf(file, "%s %s", sample ? ";" : "", entry->samples[sample]);
+		}
+		fprintf(file, "\nASCII 63: '?'\nMatrix:\n");
+		write_character_matrix(file, &glyph, width);
+		fprintf(file, "\n");
+	}
+
+	fclose(file);
+	printf("Unknown glyphs saved to: %s (%d distinct)\n", UNKNOWN_GLYPHS_FILE, unknown_glyph_count);
+}
+
+// Function to turn the Hamming distance of a match into a confidence digit, '9' for an exact match and '0' for none
+char confidence_digit(int distance) {
+	if (distance < 0)
+		return '0';
+	return (char)('9' - (9 * distance + max_glyph_distance) / (max_glyph_distance + 1));
+}
+
+// Function to find the stored glyph with the fewest differing pixels among the widths near the input width,
+// returns the glyph number (or -1 if there is no candidate) and its distance
+int find_nearest_glyph(const glyph_set *set, const packed_glyph *character, int char_width, int *distance) {
+	int best_glyph = -1;
+	int best_distance = MATRIX_ROWS * MATRIX_COLS + 1;
+
+	// Exact width first, then nearest widths, so ties go to the most plausible width and the lowest ASCII code
+	for (int offset = 0; offset <= BORDER_TOLERANCE; offset++) {
+		int widths[2] = {char_width - offset, char_width + offset};
+		for (int side = 0; side < (offset ? 2 : 1); side++) {
+			int width = widths[side];
+			if (width <= 0 || width > MATRIX_COLS)
+				continue;
+
+			for (int i = 0; i < set->bucket_sizes[width]; i++) {
+				int glyph = set->buckets[width][i];
+				int glyph_diff = glyph_distance(&set->glyphs[glyph], character);
+				if (glyph_diff < best_distance) {
+					best_distance = glyph_diff;
+					best_glyph = glyph;
+				}
+			}
+		}
+	}
+
+	*distance = best_distance;
+	return best_glyph;
+}
+
+// Function to compare a given character matrix with stored ASCII matrices. Sets 'distance' to the number of
+// differing pixels of the match, or -1 if nothing was close enough.
+char match_character(const packed_glyph *character, int char_width, int *distance) {
+	const glyph_set *set = active_profile->glyphs;
+	*distance = 0;
+
+	// Exact-width matches: a few pixel probes pick the only possible candidate, one compare verifies it
+	int tree_glyph = find_glyph_by_tree(set, character, char_width);
+	if (tree_glyph >= 0 && set->widths[tree_glyph] == char_width && glyphs_equal(&set->glyphs[tree_glyph], character)) {
+		return (char)set->codes[tree_glyph];
+	}
+
+	// Off-by-border widths: probe the neighbouring widths in the hash index, nearest first. Bits outside a glyph's
+	// width are always zero, so an exact hit also requires the extra columns of the wider one to be blank.
+	if (char_width <= MATRIX_COLS) {
+		for (int offset = 1; offset <= BORDER_TOLERANCE; offset++) {
+			int widths[2] = {char_width - offset, char_width + offset};
+			for (int side = 0; side < 2; side++) {
+				int width = widths[side];
+				if (width <= 0 || width > MATRIX_COLS)
+					continue;
+
+				int indexed_glyph = find_glyph_by_hash(set, character, width);
+				if (indexed_glyph >= 0) {
+					// printf("Matched ASCII character: %c (Width: %d, Input Width: %d)\n", (char)set->codes[indexed_glyph], width, char_width);
+					return (char)set->codes[indexed_glyph];
+				}
+			}
+		}
+	}
+
+	// No exact match: accept the nearest glyph if only a few pixels differ
+	if (char_width <= MATRIX_COLS) {
+		int nearest_distance;
+		int nearest_glyph = find_nearest_glyph(set, character, char_width, &nearest_distance);
+		if (nearest_glyph >= 0 && nearest_distance <= max_glyph_distance) {
+			*distance = nearest_distance;
+			return (char)set->codes[nearest_glyph];
+		}
+	}
+
+	// Keep it for the unknown glyphs file instead of printing it here
+	harvest_unknown_glyph(set, character, char_width);
+	*distance = -1;
+	return '?';
+}
+
+// Function to write a block of text to a specified file, replacing its contents. A file that could not be written
+// completely is removed, since an existing output file marks its frame as done.
+void write_text_to_file(const char *filename, const char *text, size_t length) {
+	FILE *file = fopen(filename, "w");
+	if (!file) {
+		perror("Error opening output file");
+		return;
+	}
+	bool written = fwrite(text, 1, length, file) == length;
+	if (fclose(file) != 0 || !written) { // Network shares often report write errors only on close
+		perror("Error writing output file");
+		remove(filename);
+	}
+}
+
+// Function to append text to a text buffer, growing it as needed
+bool append_text(text_buffer *buffer, const char *text, size_t length) {
+	if (length == 0)
+		return true;
+	if (buffer->length + length > buffer->capacity) {
+		size_t capacity = buffer->capacity ? buffer->capacity : 256;
+		while (capacity < buffer->length + length) {
+			capacity *= 2;
+		}
+		char *data = (char *)realloc(buffer->data, capacity);
+		if (!data) {
+			printf("Failed to allocate memory for text buffer.\n");
+			return false;
+		}
+		buffer->data = data;
+		buffer->capacity = capacity;
+	}
+	memcpy(buffer->data + buffer->length, text, length);
+	buffer->length += length;
+	return true;
+}
+
+// Function to append a recognized character and its confidence digit to the current line
+void append_line_character(char matched_char, int distance) {
+	append_text(&line_text, &matched_char, 1);
+	if (confidence_filepath[0]) {
+		char digit = matched_char == '\n' ? '\n' : confidence_digit(distance);
+		append_text(&line_confidence, &digit, 1);
+	}
+	if (matched_char != '\n') {
+		frame_glyphs++;
+	}
+	if (distance < 0) {
+		line_has_unknown = true;
+		frame_unknown_glyphs++;
+	}
+}
+
+// Function to allocate a cleared bit plane. Rows are padded to PLANE_ALIGN bytes and a few spare bytes
+// follow the last row, so bit reads may load a whole 32-bit word at any pixel.
+bool allocate_bit_plane(bit_plane *plane, int width, int height) {
+	plane->width = width;
+	plane->height = height;
+	plane->stride = ((width + 7) / 8 + PLANE_ALIGN - 1) / PLANE_ALIGN * PLANE_ALIGN;
+	plane->bits = (uint8_t *)calloc((size_t)plane->stride * height + sizeof(uint32_t), 1);
+	if (!plane->bits) {
+		printf("Failed to allocate memory for bit plane.\n");
+		return false;
+	}
+	return true;
+}
+
+// Function to read one pixel of a bit plane
+static inline int plane_pixel(const bit_plane *plane, int x, int y) {
+	return (plane->bits[(size_t)y * plane->stride + (x >> 3)] >> (x & 7)) & 1;
+}
+
+// Function to clip a panel region to the frame, with its columns widened to whole binarization kernel blocks
+panel_roi clip_panel_roi(const panel_roi *roi, int width, int height) {
+	int x0 = roi->x < 0 ? 0 : roi->x & ~(BINARIZE_BLOCK - 1);
+	int x1 = (roi->x + roi->width + BINARIZE_BLOCK - 1) & ~(BINARIZE_BLOCK - 1);
+	int y0 = roi->y < 0 ? 0 : roi->y;
+	int y1 = roi->y + roi->height;
+	x1 = x1 > width ? width : x1;
+	y1 = y1 > height ? height : y1;
+	panel_roi clipped = {x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0};
+	return clipped;
+}
+
+// Function to binarize an RGB(A) image into a bit plane: pixels whose three colour channels are all 221 become 1.
+// With panel regions only their pixels are binarized and the rest of the plane stays 0.
+bool binarize_image(const unsigned char *image, int width, int height, int channels, const panel_roi *rois, int roi_count, bit_plane *plane) {
+	if (channels < 3) {
+		printf("Image does not have enough channels to process.\n");
+		return false;
+	}
+	if (!allocate_bit_plane(plane, width, height)) {
+		return false;
+	}
+
+	if (roi_count == 0) {
+		for (int y = 0; y < height; y++) {
+			binarize_row(image + (size_t)y * width * channels, width, channels, plane->bits + (size_t)y * plane->stride);
+		}
+		return true;
+	}
+
+	for (int i = 0; i < roi_count; i++) {
+		panel_roi roi = clip_panel_roi(&rois[i], width, height);
+		for (int y = roi.y; y < roi.y + roi.height; y++) {
+			binarize_row(image + ((size_t)y * width + roi.x) * channels, roi.width, channels, plane->bits + (size_t)y * plane->stride + roi.x / 8);
+		}
+	}
+	return true;
+}
+
+// Function to make a view of a rectangle of a bit plane
+static inline plane_view plane_region(const bit_plane *plane, int x, int y, int width, int height) {
+	plane_view view = {plane->bits, plane->stride, x, y, width, height};
+	return view;
+}
+
+// Function to make a view of a rectangle of another view
+static inline plane_view view_region(const plane_view *view, int x, int y, int width, int height) {
+	plane_view region = {view->bits, view->stride, view->x0 + x, view->y0 + y, width, height};
+	return region;
+}
+
+// Function to read one pixel of a view
+static inline int view_pixel(const plane_view *view, int x, int y) {
+	x += view->x0;
+	return (view->bits[(size_t)(view->y0 + y) * view->stride + (x >> 3)] >> (x & 7)) & 1;
+}
+
+// Function to read up to 25 consecutive pixels of a view row starting at x, pixel x ends up in bit 0
+static inline uint32_t view_bits(const plane_view *view, int x, int y, int count) {
+	x += view->x0;
+	const uint8_t *src = view->bits + (size_t)(view->y0 + y) * view->stride + (x >> 3);
+	uint32_t word = (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+	return (word >> (x & 7)) & ((1u << count) - 1);
+}
+
+// Function to find a profile by name, returns NULL if there is none
+const glyph_profile *find_profile(const char *name) {
+	for (int i = 0; i < PROFILE_COUNT; i++) {
+		if (strcmp(profiles[i].name, name) == 0) {
+			return &profiles[i];
+		}
+	}
+	return NULL;
+}
+
+// Function to detect the default-font profile of a frame from its text strokes: at GUI scale N every horizontal
+// run of text pixels is a multiple of N pixels long, so pick the largest scale that nearly all runs agree with.
+// Single-pixel runs are left out and rows are read only down to a tall blank gap under the text, so specks of the
+// game scene do not outvote the text. Every run is a multiple of 1, so scale 1 also needs the even runs to be
+// clearly too few for scale 2; otherwise the frame is too ambiguous to tell and NULL is returned.
+const glyph_profile *detect_profile(const bit_plane *image) {
+	int runs = 0;
+	int divisible[5] = {0};
+	int last_ink_row = -1;
+
+	for (int row = 0; row < image->height; row++) {
+		if (last_ink_row >= 0 && row - last_ink_row > DETECTION_BLANK_ROWS)
+			break; // Below the text bands
+		const uint8_t *line = image->bits + (size_t)row * image->stride;
+		int run = 0;
+		for (int col = 0; col <= image->width; col++) {
+			// Skip empty bytes while outside a run
+			if (run == 0 && (col & 7) == 0 && col < image->width && line[col >> 3] == 0) {
+				col += 7;
+				continue;
+			}
+			if (col < image->width && plane_pixel(image, col, row)) {
+				run++;
+			} else if (run > 0) {
+				last_ink_row = row;
+				if (run > 1) {
+					runs++;
+					for (int scale = 1; scale <= 4; scale++) {
+						divisible[scale] += (run % scale == 0);
+					}
+				}
+				run = 0;
+			}
+		}
+	}
+
+	if (runs < MIN_DETECTION_RUNS)
+		return NULL; // Not enough text to tell
+
+	int scale = 0;
+	for (int candidate = 4; candidate >= 2 && !scale; candidate--) {
+		if (divisible[candidate] * 10 >= runs * 9) {
+			scale = candidate; // Allow a few stray runs from the game scene
+		}
+	}
+	if (!scale && divisible[2] * 100 < runs * SCALE1_MAX_EVEN_PERCENT) {
+		scale = 1;
+	}
+
+	for (int i = 0; scale && i < PROFILE_COUNT; i++) {
+		if (profiles[i].gui_scale == scale) {
+			return &profiles[i];
+		}
+	}
+	return NULL;
+}
+
+// Function to check whether a row of a bit plane has a white pixel among width pixels starting at x
+bool plane_row_has_ink(const bit_plane *plane, int y, int x, int width) {
+	const uint8_t *line = plane->bits + (size_t)y * plane->stride;
+	int end = x + width;
+	for (; x < end && (x & 7); x++) {
+		if (plane_pixel(plane, x, y))
+			return true;
+	}
+	for (; x + 64 <= end; x += 64) {
+		uint64_t bits;
+		memcpy(&bits, line + (x >> 3), sizeof(bits));
+		if (bits)
+			return true;
+	}
+	for (; x + 8 <= end; x += 8) {
+		if (line[x >> 3])
+			return true;
+	}
+	for (; x < end; x++) {
+		if (plane_pixel(plane, x, y))
+			return true;
+	}
+	return false;
+}
+
+// Function to find the text lines of a frame from its row projection. Rows are scanned top down only until
+// MAX_BLANK_LINES empty line pitches follow the last text, and the line grid is aligned to wherever the gaps
+// between lines actually are, so captures that are cropped or shifted vertically still split cleanly.
+bool find_text_lines(const bit_plane *image, line_grid *grid) {
+	int column_width = image->width / 2;
+	int line_pitch = active_profile->line_pitch;
+	int glyph_rows = active_profile->glyph_rows;
+	grid->origin = active_profile->top_margin + active_profile->glyph_top;
+	grid->count = 0;
+	grid->ink = NULL;
+
+	// Row projection, bit 0 for the left column and bit 1 for the right one
+	uint8_t *row_ink = (uint8_t *)calloc(image->height, 1);
+	if (!row_ink) {
+		printf("Failed to allocate memory for row projection.\n");
+		return false;
+	}
+	int ink_rows_by_phase[64] = {0}; // line_pitch is at most 36
+	int last_ink_row = -1;
+	for (int y = 0; y < image->height; y++) {
+		if (last_ink_row >= 0 && y - last_ink_row > MAX_BLANK_LINES * line_pitch)
+			break; // Past the bottom of the panel
+
+		row_ink[y] = (uint8_t)(plane_row_has_ink(image, y, 0, column_width) | (plane_row_has_ink(image, y, column_width, column_width) << 1));
+		if (row_ink[y]) {
+			last_ink_row = y;
+			ink_rows_by_phase[y % line_pitch]++;
+		}
+	}
+
+	// Text never reaches into the rows between two lines; keep the profile's grid unless another phase leaves fewer text rows there
+	int best_gap_rows = -1;
+	int nominal_phase = grid->origin % line_pitch;
+	for (int i = 0; i < line_pitch; i++) {
+		int phase = (nominal_phase + i) % line_pitch;
+		int gap_rows = 0;
+		for (int r = glyph_rows; r < line_pitch; r++) {
+			gap_rows += ink_rows_by_phase[(phase + r) % line_pitch];
+		}
+		if (best_gap_rows < 0 || gap_rows < best_gap_rows) {
+			best_gap_rows = gap_rows;
+			grid->origin = phase;
+		}
+	}
+
+	// Lines down to the last text row, as long as their glyph rows fit in the frame
+	if (last_ink_row >= grid->origin) {
+		grid->count = (last_ink_row - grid->origin) / line_pitch + 1;
+	}
+	while (grid->count > 0 && grid->origin + (grid->count - 1) * line_pitch + glyph_rows > image->height) {
+		grid->count--;
+	}
+
+	grid->ink = (uint8_t *)calloc(grid->count + 1, 1);
+	if (!grid->ink) {
+		printf("Failed to allocate memory for text lines.\n");
+		free(row_ink);
+		return false;
+	}
+	for (int i = 0; i < grid->count; i++) {
+		int top = grid->origin + i * line_pitch;
+		for (int y = top; y < top + glyph_rows; y++) {
+			grid->ink[i] |= row_ink[y];
+		}
+	}
+	free(row_ink);
+	return true;
+}
+
+// Function to view the glyph rows of all text lines of the left and right F3 columns, no pixels are copied
+bool divide_single_channel_image_to_columns(const bit_plane *image, const line_grid *grid, plane_view *left_column, plane_view *right_column) {
+	int width = image->width;
+	int height = grid->count > 0 ? (grid->count - 1) * active_profile->line_pitch + active_profile->glyph_rows : 0;
+
+	// Validate dimensions
+	if (width % 2 != 0) {
+		printf("Error: Image width must be even to divide into two equal columns.\n");
+		return false;
+	}
+
+	// Calculate dimensions for each column
+	int column_width = width / 2;
+
+	*left_column = plane_region(image, 0, grid->origin, column_width, height);
+	*right_column = plane_region(image, column_width, grid->origin, column_width, height);
+	return true;
+}
+
+// Function to build the column occupancy profile of a band of rows: bit N of the one-row profile plane is set
+// when column N of the view has a white pixel in any row of the band. Rows are ORed whole words at a time, top to
+// bottom, and the profile keeps the view's column offset so it can be viewed over the same columns.
+void build_column_profile(const plane_view *view, int first_row, int height, bit_plane *profile) {
+	int first_word = view->x0 / 64;
+	int end_word = (view->x0 + view->width + 63) / 64;
+	uint64_t *out = (uint64_t *)profile->bits;
+	memset(out, 0, profile->stride);
+	for (int y = view->y0 + first_row; y < view->y0 + first_row + height; y++) {
+		const uint8_t *line = view->bits + (size_t)y * view->stride;
+		for (int word = first_word; word < end_word; word++) {
+			uint64_t bits;
+			memcpy(&bits, line + word * sizeof(uint64_t), sizeof(bits));
+			out[word] |= bits;
+		}
+	}
+
+	// Drop the neighbouring columns that share the first and last word
+	int begin = view->x0, end = view->x0 + view->width;
+	out[first_word] &= ~0ULL << (begin & 63);
+	if (end & 63) {
+		out[end_word - 1] &= ~(~0ULL << (end & 63));
+	}
+}
+
+// Function to find the first and last set column of a profile among width columns starting at x, returns false if none is set
+bool profile_ink_range(const bit_plane *profile, int x, int width, int *first_col, int *last_col) {
+	if (width <= 0)
+		return false;
+
+	int first_byte = x / 8;
+	int last_byte = (x + width - 1) / 8;
+	for (int byte = first_byte; byte <= last_byte; byte++) {
+		if (profile->bits[byte]) {
+			*first_col = byte * 8 + __builtin_ctz(profile->bits[byte]) - x;
+			break;
+		}
+		if (byte == last_byte)
+			return false;
+	}
+	for (int byte = last_byte; byte >= first_byte; byte--) {
+		if (profile->bits[byte]) {
+			*last_col = byte * 8 + 31 - __builtin_clz(profile->bits[byte]) - x;
+			break;
+		}
+	}
+	return true;
+}
+
+// Function to learn the left and right panel regions from a whole binarized frame: the text of each column
+// plus ROI_MARGIN_LINES line pitches of room, or the whole column when it has no text
+void learn_panel_regions(const bit_plane *image, const line_grid *grid) {
+	int column_width = image->width / 2;
+	int margin = ROI_MARGIN_LINES * active_profile->line_pitch;
+	int bottom = grid->origin + grid->count * active_profile->line_pitch;
+	bottom = bottom > image->height ? image->height : bottom;
+
+	bit_plane profile;
+	if (!allocate_bit_plane(&profile, image->width, 1)) {
+		return;
+	}
+
+	for (int side = 0; side < 2; side++) {
+		int column_x = side * column_width;
+		panel_roi *roi = &panel_rois[side];
+		plane_view column = plane_region(image, column_x, 0, column_width, bottom);
+		int first_col, last_col;
+		build_column_profile(&column, 0, bottom, &profile);
+		if (bottom == 0 || !profile_ink_range(&profile, column_x, column_width, &first_col, &last_col)) {
+			roi->x = column_x;
+			roi->y = 0;
+			roi->width = column_width;
+			roi->height = image->height;
+			continue;
+		}
+
+		int x0 = first_col - margin < 0 ? 0 : first_col - margin;
+		int x1 = last_col + 1 + margin > column_width ? column_width : last_col + 1 + margin;
+		int y1 = bottom + margin > image->height ? image->height : bottom + margin;
+		roi->x = column_x + x0;
+		roi->y = 0;
+		roi->width = x1 - x0;
+		roi->height = y1;
+	}
+	free(profile.bits);
+
+	panel_rois_set = true;
+	printf("Learned panel regions: left %dx%d at %d,%d, right %dx%d at %d,%d\n", panel_rois[0].width, panel_rois[0].height, panel_rois[0].x, panel_rois[0].y,
+		   panel_rois[1].width, panel_rois[1].height, panel_rois[1].x, panel_rois[1].y);
+}
+
+// Function to check whether a rectangle of a bit plane has a white pixel
+bool region_has_ink(const bit_plane *plane, int x, int y, int width, int height) {
+	for (int row = y; row < y + height; row++) {
+		if (plane_row_has_ink(plane, row, x, width))
+			return true;
+	}
+	return false;
+}
+
+// Function to check that the text of a frame binarized within the panel regions stays clear of their inner edges.
+// Text running past an edge must cross the band along it, which is wider than any gap within or between lines.
+bool panel_regions_hold(const bit_plane *image) {
+	int column_width = image->width / 2;
+	int band_cols = 2 * active_profile->space_columns;
+	int band_rows = 2 * active_profile->line_pitch;
+
+	for (int side = 0; side < 2; side++) {
+		panel_roi roi = clip_panel_roi(&panel_rois[side], image->width, image->height);
+		int right = roi.x + roi.width, bottom = roi.y + roi.height;
+		int cols = band_cols < roi.width ? band_cols : roi.width;
+		int rows = band_rows < roi.height ? band_rows : roi.height;
+
+		// Edges on the frame border or on the split between the columns have nothing beyond them
+		if (roi.x > 0 && roi.x != column_width && region_has_ink(image, roi.x, roi.y, cols, roi.height))
+			return false;
+		if (right < image->width && right != column_width && region_has_ink(image, right - cols, roi.y, cols, roi.height))
+			return false;
+		if (roi.y > 0 && region_has_ink(image, roi.x, roi.y, roi.width, rows))
+			return false;
+		if (bottom < image->height && region_has_ink(image, roi.x, bottom - rows, roi.width, rows))
+			return false;
+	}
+	return true;
+}
+
+// Function to transpose a text line into column-major order: bit Y of columns[X] is glyph-set row Y at screen column X,
+// sampled every sample_step rows. Only the white pixels are visited, one set bit at a time.
+void build_line_columns(const plane_view *line, int step, uint16_t *columns) {
+	int rows = line->height / step;
+	if (rows > MATRIX_ROWS) {
+		rows = MATRIX_ROWS;
+	}
+	memset(columns, 0, line->width * sizeof(uint16_t));
+
+	int first_word = line->x0 / 64;
+	int end_word = (line->x0 + line->width + 63) / 64;
+	for (int y = 0; y < rows; y++) {
+		const uint8_t *src = line->bits + (size_t)(line->y0 + y * step) * line->stride;
+		for (int word = first_word; word < end_word; word++) {
+			uint64_t bits;
+			memcpy(&bits, src + word * sizeof(uint64_t), sizeof(bits));
+			while (bits) {
+				int x = word * 64 + __builtin_ctzll(bits) - line->x0;
+				bits &= bits - 1;
+				if (x >= 0 && x < line->width) {
+					columns[x] |= (uint16_t)(1u << y);
+				}
+			}
+		}
+	}
+}
+
+// Function to hash the bitmap of a cropped line together with its size and the active profile
+uint64_t hash_line(const plane_view *line) {
+	uint64_t hash = ((uint64_t)line->width << 32 | (uint32_t)line->height) * 0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)active_profile;
+	for (int y = 0; y < line->height; y++) {
+		for (int x = 0; x < line->width; x += 24) {
+			int count = line->width - x < 24 ? line->width - x : 24;
+			hash = ((hash << 23 | hash >> 41) ^ view_bits(line, x, y, count)) * 0xFF51AFD7ED558CCDULL;
+		}
+	}
+	hash ^= hash >> 32;
+	return hash ? hash : 1;
+}
+
+// Function to look up a line bitmap hash in the line cache, returns NULL if it is not cached
+cached_line *find_cached_line(uint64_t hash) {
+	cached_line *set = line_cache[hash & (LINE_CACHE_SETS - 1)];
+	for (int way = 0; way < LINE_CACHE_WAYS; way++) {
+		if (set[way].hash == hash) {
+			set[way].last_used = ++line_cache_clock;
+			return &set[way];
+		}
+	}
+	return NULL;
+}
+
+// Function to remember the text of the current line under its bitmap hash, replacing the least recently used line of its set
+void cache_line(uint64_t hash) {
+	cached_line *set = line_cache[hash & (LINE_CACHE_SETS - 1)];
+	cached_line *entry = &set[0];
+	for (int way = 1; way < LINE_CACHE_WAYS && entry->hash; way++) {
+		if (!set[way].hash || set[way].last_used < entry->last_used) {
+			entry = &set[way];
+		}
+	}
+
+	entry->hash = 0;
+	entry->text.length = entry->confidence.length = 0;
+	if (!append_text(&entry->text, line_text.data, line_text.length) || !append_text(&entry->confidence, line_confidence.data, line_confidence.length)) {
+		return;
+	}
+	entry->hash = hash;
+	entry->last_used = ++line_cache_clock;
+}
+
+// Function to make room for the line texts of a frame and clear them
+bool prepare_frame_lines(frame_lines *frame, int line_count) {
+	if (line_count > frame->line_capacity) {
+		for (int side = 0; side < 2; side++) {
+			text_buffer *text = (text_buffer *)realloc(frame->text[side], line_count * sizeof(text_buffer));
+			if (!text) {
+				printf("Failed to allocate memory for frame lines.\n");
+				return false;
+			}
+			frame->text[side] = text;
+			memset(text + frame->line_capacity, 0, (line_count - frame->line_capacity) * sizeof(text_buffer));
+
+			text_buffer *confidence = (text_buffer *)realloc(frame->confidence[side], line_count * sizeof(text_buffer));
+			if (!confidence) {
+				printf("Failed to allocate memory for frame lines.\n");
+				return false;
+			}
+			frame->confidence[side] = confidence;
+			memset(confidence + frame->line_capacity, 0, (line_count - frame->line_capacity) * sizeof(text_buffer));
+		}
+		frame->line_capacity = line_count;
+	}
+	for (int side = 0; side < 2; side++) {
+		for (int line = 0; line < frame->line_capacity; line++) {
+			frame->text[side][line].length = frame->confidence[side][line].length = 0;
+		}
+	}
+	frame->line_count = line_count;
+	return true;
+}
+
+// Function to check whether two bit planes of the same size are identical within a rectangle, a word at a time
+bool planes_equal_in_region(const bit_plane *a, const bit_plane *b, int x, int y, int width, int height) {
+	int first_word = x / 64;
+	int end_word = (x + width + 63) / 64;
+	uint64_t first_mask = ~0ULL << (x & 63);
+	uint64_t last_mask = ((x + width) & 63) ? ~(~0ULL << ((x + width) & 63)) : ~0ULL;
+	for (int row = y; row < y + height; row++) {
+		const uint8_t *line_a = a->bits + (size_t)row * a->stride;
+		const uint8_t *line_b = b->bits + (size_t)row * b->stride;
+		for (int word = first_word; word < end_word; word++) {
+			uint64_t bits_a, bits_b;
+			memcpy(&bits_a, line_a + word * sizeof(uint64_t), sizeof(bits_a));
+			memcpy(&bits_b, line_b + word * sizeof(uint64_t), sizeof(bits_b));
+			uint64_t diff = bits_a ^ bits_b;
+			if (word == first_word) {
+				diff &= first_mask;
+			}
+			if (word == end_word - 1) {
+				diff &= last_mask;
+			}
+			if (diff)
+				return false;
+		}
+	}
+	return true;
+}
+
+// Function to check whether a line of a column has exactly the pixels it had in the previous frame, whose text was kept
+bool line_unchanged(const bit_plane *image, const plane_view *column, int line, int side) {
+	const frame_lines *previous = &previous_frame;
+	if (!previous->plane.bits || previous->profile != active_profile || previous->origin != column->y0 || line >= previous->line_count)
+		return false;
+	if (previous->plane.width != image->width || previous->plane.height != image->height || previous->text[side][line].length == 0)
+		return false;
+
+	int y = column->y0 + line * active_profile->line_pitch;
+	return planes_equal_in_region(image, &previous->plane, column->x0, y, column->width, active_profile->glyph_rows);
+}
+
+// Function to add the current line to the frame text and keep its text for the next frame
+void save_line(int side, int line) {
+	append_text(&frame_text, line_text.data, line_text.length);
+	append_text(&frame_confidence, line_confidence.data, line_confidence.length);
+
+	// Lines with unknown glyphs are not kept, so every sighting of those is harvested; skipped lines have no text to keep
+	if (!line_has_unknown && current_line_selection != LINE_SKIPPED && line < current_frame.line_count) {
+		text_buffer *text = &current_frame.text[side][line];
+		text_buffer *confidence = &current_frame.confidence[side][line];
+		if (!append_text(text, line_text.data, line_text.length) || !append_text(confidence, line_confidence.data, line_confidence.length)) {
+			text->length = 0;
+		}
+	}
+}
+
+// Function to keep a recognized frame as the previous frame, releasing the one before it
+void remember_frame(bit_plane *image, const line_grid *grid) {
+	frame_lines older = previous_frame;
+	free(older.plane.bits);
+	older.plane.bits = NULL;
+
+	previous_frame = current_frame;
+	previous_frame.plane = *image;
+	previous_frame.profile = active_profile;
+	previous_frame.origin = grid->origin;
+	current_frame = older;
+	image->bits = NULL;
+}
+
+// Function to match the start of the dimension line, a namespaced id such as "minecraft:overworld" followed by a space
+line_selection select_dimension_line(const char *text, size_t length) {
+	bool in_path = false;
+	size_t part = 0;
+	for (size_t i = 0; i < length; i++) {
+		char c = text[i];
+		if (c == ':' && !in_path && part > 0) {
+			in_path = true;
+			part = 0;
+		} else if (c == ' ' && in_path && part > 0) {
+			return LINE_SELECTED;
+		} else if (islower((uint8_t)c) || isdigit((uint8_t)c) || c == '_' || c == '.' || c == '-' || (c == '/' && in_path)) {
+			part++;
+		} else {
+			return LINE_SKIPPED;
+		}
+	}
+	return LINE_UNDECIDED;
+}
+
+// Function to tell from the start of a line whether it holds a requested field, undecided while the text could still
+// become a requested label. complete is set when the text is the whole line. Sets line_name_follows for a selected line.
+line_selection select_line(const char *text, size_t length, bool complete) {
+	bool undecided = false;
+	for (int field = 0; field < FIELD_LABEL_COUNT; field++) {
+		if (!(requested_fields & (1u << field)))
+			continue;
+
+		const char *label = field_labels[field].label;
+		if (!label) {
+			line_selection dimension = select_dimension_line(text, length);
+			if (dimension == LINE_SELECTED)
+				return LINE_SELECTED;
+			undecided |= dimension == LINE_UNDECIDED;
+			continue;
+		}
+
+		size_t label_length = strlen(label);
+		if (memcmp(text, label, length < label_length ? length : label_length) != 0)
+			continue;
+		if (length >= label_length) {
+			line_name_follows = field_labels[field].name_follows;
+			return LINE_SELECTED;
+		}
+		undecided = true;
+	}
+	return undecided && !complete ? LINE_UNDECIDED : LINE_SKIPPED;
+}
+
+// Function to check after each recognized glyph whether the rest of the line is still needed
+bool line_cut_off(void) {
+	if (current_line_selection == LINE_UNDECIDED) {
+		current_line_selection = select_line(line_text.data, line_text.length, false);
+	}
+	return current_line_selection == LINE_SKIPPED;
+}
+
+// Function to settle the selection of a line once its whole text is known, and empty the text of a line that is not wanted
+void settle_line_selection(void) {
+	if (current_line_selection == LINE_UNDECIDED) {
+		size_t length = line_text.length;
+		if (length > 0 && line_text.data[length - 1] == '\n') {
+			length--;
+		}
+		current_line_selection = select_line(line_text.data, length, true);
+	}
+	if (current_line_selection == LINE_SKIPPED) {
+		line_text.length = line_confidence.length = 0;
+		append_line_character('\n', 0);
+	}
+}
+
+int character_index = 0;
+
+// Main function to process the row, segmented by the column occupancy profile of the cropped row, or by the
+// row's column-major words when columns is not NULL (profile is unused then)
+void extract_characters(const plane_view *cropped_row, const plane_view *profile, const uint16_t *columns) {
+	int cropped_width = cropped_row->width;
+	int cropped_height = cropped_row->height;
+	int start_col = -1;
+	int space_count = 0;
+	int space_columns = active_profile->space_columns;
+	int step = active_profile->sample_step;
+
+	for (int col = 0; col < cropped_width; col++) {
+		bool has_ink = columns ? columns[col] != 0 : view_pixel(profile, col, 0);
+		if (!has_ink) {
+			space_count++;
+			if (space_count == space_columns) {
+				start_col = col - space_columns;
+			}
+		} else {
+			space_count = 0;
+		}
+
+		if (has_ink) {
+			if (start_col == -1) {
+				start_col = col;
+			}
+		} else {
+			if (start_col != -1) {
+				int end_col = col - 1;
+				int ink_width = (end_col - start_col + step) / step;
+				int char_width = ink_width + 2; // Include 1-pixel black borders
+
+				// Split the run into known glyphs by their column words, the classifier below takes what does not parse
+				int16_t run_glyphs[MAX_RUN_COLUMNS], run_starts[MAX_RUN_COLUMNS];
+				int parsed = 0;
+				if (use_column_automaton && columns && space_count != space_columns && ink_width <= MAX_RUN_COLUMNS) {
+					uint16_t run[MAX_RUN_COLUMNS];
+					for (int x = 0; x < ink_width; x++) {
+						run[x] = columns[start_col + x * step];
+					}
+					parsed = parse_ink_run(&active_profile->glyphs->automaton, run, ink_width, run_glyphs, run_starts);
+				}
+				for (int i = 0; i < parsed; i++) {
+					current_location.x = current_location.line_x + start_col + run_starts[i] * step;
+					append_line_character((char)active_profile->glyphs->codes[run_glyphs[i]], 0);
+				}
+				if (parsed > 0) {
+					start_col = -1;
+					if (line_cut_off())
+						break;
+					continue;
+				}
+
+				// Pack the character data at glyph-set resolution, including 1-pixel black borders (column 0 stays black)
+				packed_glyph character = {{0}};
+				int packed_rows = cropped_height / step;
+				if (packed_rows > MATRIX_ROWS) {
+					packed_rows = MATRIX_ROWS;
+				}
+				int packed_cols = (ink_width < MATRIX_COLS - 1) ? ink_width : MATRIX_COLS - 1;
+				for (int x = 0; columns && x < packed_cols; x++) {
+					// Transpose back one set bit at a time
+					for (uint32_t bits = columns[start_col + x * step]; bits; bits &= bits - 1) {
+						character.rows[__builtin_ctz(bits)] |= (uint16_t)(2u << x);
+					}
+				}
+				for (int y = 0; !columns && y < packed_rows; y++) {
+					uint16_t bits = 0;
+					if (step == 1) {
+						bits = (uint16_t)view_bits(cropped_row, start_col, y, packed_cols);
+					} else {
+						for (int x = 0; x < packed_cols; x++) {
+							bits |= (uint16_t)(view_pixel(cropped_row, start_col + x * step, y * step) << x);
+						}
+					}
+					character.rows[y] = (uint16_t)(bits << 1);
+				}
+
+				// Handle spaces (space_columns black columns in a row)
+				if (space_count == space_columns) {
+					space_count = 0;
+					memset(&character, 0, sizeof(character));
+				}
+
+				int distance;
+				current_location.x = current_location.line_x + start_col;
+				char matched_char = match_character(&character, char_width, &distance);
+				append_line_character(matched_char, distance);
+
+				start_col = -1;
+				if (line_cut_off())
+					break;
+			}
+		}
+	}
+	append_line_character('\n', 0);
+}
+
+// Function to divide a column into the text lines of the grid, crop rows, and add their text to the frame text.
+// side_bit selects the column's bit in grid->ink; lines without text, and with --fields lines of fields that were
+// not asked for, are added as empty.
+void recognize_and_save_text_from_columns(const bit_plane *image, const plane_view *column, const line_grid *grid, int side_bit) {
+	int side = side_bit - 1;
+	int width = column->width;
+	int line_pitch = active_profile->line_pitch;
+	int num_rows = grid->count;
+
+	// The profile is indexed like the frame, so it covers the columns left of this one too
+	bit_plane profile;
+	if (!allocate_bit_plane(&profile, column->x0 + width, 1)) {
+		return;
+	}
+	uint16_t *columns = NULL;
+	if (column_major_lines && !(columns = (uint16_t *)malloc(width * sizeof(uint16_t)))) {
+		printf("Failed to allocate memory for line columns.\n");
+		free(profile.bits);
+		return;
+	}
+
+	bool name_follows = false; // The previous line was a selected label whose name is on this line
+	for (int i = 0; i < num_rows; i++) {
+		// A line is wanted when every field is, when it holds the name of the line above, or when its start says so
+		current_line_selection = requested_fields && !name_follows ? LINE_UNDECIDED : LINE_SELECTED;
+		line_name_follows = name_follows = false;
+
+		// Extract the current row, the column starts at the first line's glyph rows
+		int row = i * line_pitch;
+		int effective_height = active_profile->glyph_rows;
+		if (effective_height <= 0)
+			continue; // Ensure valid height
+
+		if (!(grid->ink[i] & side_bit)) {
+			append_text(&frame_text, "\n", 1);
+			if (confidence_filepath[0]) {
+				append_text(&frame_confidence, "\n", 1);
+			}
+			continue;
+		}
+
+		// A line with the same pixels as in the previous frame has the same text
+		line_text.length = line_confidence.length = 0;
+		line_has_unknown = false;
+		if (line_unchanged(image, column, i, side)) {
+			append_text(&line_text, previous_frame.text[side][i].data, previous_frame.text[side][i].length);
+			append_text(&line_confidence, previous_frame.confidence[side][i].data, previous_frame.confidence[side][i].length);
+			settle_line_selection();
+			save_line(side, i);
+			name_follows = line_name_follows;
+			continue;
+		}
+
+		// One sweep over the band gives every column's occupancy, then find the first and last column containing white pixels
+		int first_col = -1, last_col = -1;
+		if (columns) {
+			plane_view line = view_region(column, 0, row, width, effective_height);
+			build_line_columns(&line, active_profile->sample_step, columns);
+			for (int x = 0; x < width; x++) {
+				if (columns[x]) {
+					first_col = first_col < 0 ? x : first_col;
+					last_col = x;
+				}
+			}
+		} else {
+			build_column_profile(column, row, effective_height, &profile);
+			profile_ink_range(&profile, column->x0, width, &first_col, &last_col);
+		}
+
+		// If no white pixel found, skip saving this row
+		if (first_col < 0) {
+			append_text(&frame_text, "\n", 1);
+			if (confidence_filepath[0]) {
+				append_text(&frame_confidence, "\n", 1);
+			}
+			continue;
+		}
+
+		// Add a black border by including one column on both sides
+		first_col = (first_col > 0) ? first_col - 1 : first_col;
+		last_col = (last_col < width - 1) ? last_col + 1 : last_col;
+
+		int cropped_width = last_col - first_col + 1;
+		int cropped_height = effective_height;
+
+		// View the cropped row and its slice of the profile in place
+		plane_view cropped_row = view_region(column, first_col, row, cropped_width, cropped_height);
+		plane_view cropped_profile = plane_region(&profile, column->x0 + first_col, 0, cropped_width, 1);
+
+		// Lines that look exactly like one recognized before take its text
+		uint64_t hash = hash_line(&cropped_row);
+		cached_line *cached = find_cached_line(hash);
+		if (cached) {
+			append_text(&line_text, cached->text.data, cached->text.length);
+			append_text(&line_confidence, cached->confidence.data, cached->confidence.length);
+			settle_line_selection();
+			save_line(side, i);
+			name_follows = line_name_follows;
+			continue;
+		}
 
-	fclose(file);
-}
+		current_location.line = i + 1;
+		current_location.line_x = first_col;
+		extract_characters(&cropped_row, &cropped_profile, columns ? columns + first_col : NULL);
+		settle_line_selection();
+		save_line(side, i);
+		name_follows = line_name_follows;
 
-// Function to print a given character matrix
-void print_character_matrix(unsigned char *character, int char_width, int cropped_height) {
-	printf("First character:\n");
-	for (int row = 0; row < cropped_height; row++) {
-		for (int col = 0; col < char_width; col++) {
-			printf("%c", character[row * char_width + col] == 255 ? '1' : '0');
+		// Lines with unknown glyphs are left out, so every sighting of those is harvested; skipped lines were cut off
+		if (!line_has_unknown && current_line_selection != LINE_SKIPPED) {
+			cache_line(hash);
 		}
-		printf("\n");
 	}
-	printf("\n");
+	free(columns);
+	free(profile.bits);
 }
 
-// Function to compare a given character matrix with stored ASCII matrices
-char match_character(unsigned char *character, int char_width, int cropped_height) {
-	for (int ascii_code = 0; ascii_code < MAX_ASCII; ascii_code++) {
-		int matrix_width = ascii_matrix_widths[ascii_code];
-		if (matrix_width == 0)
-			continue; // Skip uninitialized matrices
+// Function to hash a file name for the dataset source set (FNV-1a)
+uint32_t hash_string(const char *text) {
+	uint32_t hash = 2166136261u;
+	for (; *text; text++) {
+		hash = (hash ^ (uint8_t)*text) * 16777619u;
+	}
+	return hash;
+}
 
-		// Compare using the smaller width
-		int min_width = (matrix_width < char_width) ? matrix_width : char_width;
-		int match = 1;
+// Function to check whether a source file name is already in the dataset
+bool dataset_has_source(const char *name) {
+	if (dataset_source_capacity == 0)
+		return false;
 
-		for (int row = 0; row < cropped_height && match; row++) {
-			if (row >= MATRIX_ROWS)
-				break; // Avoid accessing beyond stored rows
+	uint32_t slot = hash_string(name) & (dataset_source_capacity - 1);
+	while (dataset_sources[slot]) {
+		if (strcmp(dataset_sources[slot], name) == 0)
+			return true;
+		slot = (slot + 1) & (dataset_source_capacity - 1);
+	}
+	return false;
+}
 
-			for (int col = 0; col < min_width; col++) {
-				char expected = ascii_matrices[ascii_code][row][col];
-				unsigned char actual = character[row * char_width + col];
+// Function to add a source file name to the dataset source set, growing it as needed
+bool add_dataset_source(const char *name) {
+	if (dataset_has_source(name))
+		return true;
 
-				if ((expected == '1' && actual != 255) || (expected == '0' && actual != 0)) {
-					match = 0;
-					break;
+	if ((dataset_source_count + 1) * 2 > dataset_source_capacity) {
+		int capacity = dataset_source_capacity ? dataset_source_capacity * 2 : 1024;
+		char **sources = (char **)calloc(capacity, sizeof(char *));
+		if (!sources) {
+			printf("Failed to allocate memory for dataset sources.\n");
+			return false;
+		}
+		for (int i = 0; i < dataset_source_capacity; i++) {
+			if (dataset_sources[i]) {
+				uint32_t slot = hash_string(dataset_sources[i]) & (capacity - 1);
+				while (sources[slot]) {
+					slot = (slot + 1) & (capacity - 1);
 				}
+				sources[slot] = dataset_sources[i];
 			}
 		}
-
-		if (match) {
-			// printf("Matched ASCII character: %c (Width: %d, Input Width: %d)\n", (char)ascii_code, matrix_width, char_width);
-			return (char)ascii_code;
-		}
+		free(dataset_sources);
+		dataset_sources = sources;
+		dataset_source_capacity = capacity;
 	}
 
-	// Debugging output
-	printf("No matching ASCII character found. Input Width: %d\n", char_width);
-	print_character_matrix(character, char_width, cropped_height);
-	return '?';
+	uint32_t slot = hash_string(name) & (dataset_source_capacity - 1);
+	while (dataset_sources[slot]) {
+		slot = (slot + 1) & (dataset_source_capacity - 1);
+	}
+	dataset_sources[slot] = strdup(name);
+	dataset_source_count++;
+	return dataset_sources[slot] != NULL;
 }
 
-// Function to write matched character to a specified file
-void write_character_to_file(const char *filename, char matched_char) {
-	FILE *file = fopen(filename, "a");
-	if (!file) {
-		perror("Error opening output file");
-		return;
+// Function to read the source file names of the records already in a dataset file. Records are written with the
+// source first, so only the start of each line is read; a missing file is an empty dataset. A last line without its
+// newline is a record that was cut off, so its frame is not counted as done.
+bool load_dataset_sources(const char *filename) {
+	FILE *file = fopen(filename, "r");
+	if (!file)
+		return true;
+
+	const char *prefix = "{\"source\":\"";
+	size_t prefix_length = strlen(prefix);
+	char line[1024];
+	char name[512];
+	bool line_start = true;
+	bool record_pending = false; // name holds the source of the current line, added once the line is complete
+	while (fgets(line, sizeof(line), file)) {
+		bool starts_record = line_start && strncmp(line, prefix, prefix_length) == 0;
+		line_start = strchr(line, '\n') != NULL; // Long lines come in several pieces
+		if (!starts_record) {
+			if (record_pending && line_start) {
+				record_pending = false;
+				if (!add_dataset_source(name)) {
+					fclose(file);
+					return false;
+				}
+			}
+			continue;
+		}
+
+		// Undo the JSON string escapes the writer uses
+		size_t length = 0;
+		for (const char *c = line + prefix_length; *c && *c != '"' && length + 1 < sizeof(name); c++) {
+			if (*c == '\\' && c[1] == 'u' && isxdigit((uint8_t)c[2]) && isxdigit((uint8_t)c[3]) && isxdigit((uint8_t)c[4]) && isxdigit((uint8_t)c[5])) {
+				char hex[5] = {c[2], c[3], c[4], c[5], 0};
+				name[length++] = (char)strtol(hex, NULL, 16);
+				c += 5;
+			} else if (*c == '\\' && c[1]) {
+				name[length++] = *++c;
+			} else {
+				name[length++] = *c;
+			}
+		}
+		name[length] = '\0';
+		record_pending = !line_start;
+		if (line_start && !add_dataset_source(name)) {
+			fclose(file);
+			return false;
+		}
 	}
-	fprintf(file, "%c", matched_char);
+	dataset_needs_newline = !line_start;
 	fclose(file);
+	return true;
 }
 
-// Function to convert RGB image to single-channel binary image
-unsigned char *convert_to_single_channel(unsigned char *image, int width, int height, int channels) {
-	if (channels < 3) {
-		printf("Image does not have enough channels to process.\n");
-		return NULL;
+// Function to append text to a buffer as a JSON string
+void append_json_string(text_buffer *buffer, const char *text, size_t length) {
+	append_text(buffer, "\"", 1);
+	for (size_t i = 0; i < length; i++) {
+		char escaped[8];
+		if (text[i] == '"' || text[i] == '\\') {
+			escaped[0] = '\\';
+			escaped[1] = text[i];
+			append_text(buffer, escaped, 2);
+		} else if ((uint8_t)text[i] < 0x20) {
+			snprintf(escaped, sizeof(escaped), "\\u%04x", (uint8_t)text[i]);
+			append_text(buffer, escaped, 6);
+		} else {
+			append_text(buffer, &text[i], 1);
+		}
 	}
+	append_text(buffer, "\"", 1);
+}
 
-	// Allocate memory for single-channel image
-	unsigned char *single_channel_image = (unsigned char *)malloc(width * height);
-	if (!single_channel_image) {
-		printf("Failed to allocate memory for single-channel image.\n");
-		return NULL;
+// Function to append the lines of a text buffer to a record as a JSON array of strings
+void append_json_lines(text_buffer *record, const text_buffer *text) {
+	append_text(record, "[", 1);
+	size_t start = 0;
+	for (size_t end = 0; end < text->length; end++) {
+		if (text->data[end] == '\n') {
+			if (start > 0) {
+				append_text(record, ",", 1);
+			}
+			append_json_string(record, text->data + start, end - start);
+			start = end + 1;
+		}
 	}
+	append_text(record, "]", 1);
+}
 
-	for (int i = 0; i < width * height; ++i) {
-		// Extract RGB values
-		unsigned char r = image[i * channels];
-		unsigned char g = image[i * channels + 1];
-		unsigned char b = image[i * channels + 2];
+// Function to make room for one more interned name, growing the id table, the slot table and the blocks as needed
+bool reserve_interned_name(size_t length) {
+	if (intern_count + 1 >= intern_names_capacity) {
+		int capacity = intern_names_capacity ? 2 * intern_names_capacity : 1024;
+		const char **names = (const char **)realloc((void *)intern_names, capacity * sizeof(*names));
+		if (!names)
+			return false;
+		intern_names = names;
+		intern_names_capacity = capacity;
+	}
 
-		// Check if all channels are equal to 221, map to 255; otherwise, map to 0
-		if (r == 221 && g == 221 && b == 221) {
-			single_channel_image[i] = 255;
-		} else {
-			single_channel_image[i] = 0;
+	if (2 * (intern_count + 1) > intern_slot_count) {
+		int slot_count = intern_slot_count ? 2 * intern_slot_count : 2048;
+		uint32_t *slots = (uint32_t *)calloc(slot_count, sizeof(uint32_t));
+		if (!slots)
+			return false;
+		for (int id = 1; id <= intern_count; id++) {
+			uint32_t slot = hash_string(intern_names[id]) & (slot_count - 1);
+			while (slots[slot]) {
+				slot = (slot + 1) & (slot_count - 1);
+			}
+			slots[slot] = (uint32_t)id;
 		}
+		free(intern_slots);
+		intern_slots = slots;
+		intern_slot_count = slot_count;
 	}
 
-	return single_channel_image;
+	if (intern_block_used + length + 1 > INTERN_BLOCK_SIZE) {
+		size_t block_size = length + 1 > INTERN_BLOCK_SIZE ? length + 1 : INTERN_BLOCK_SIZE;
+		char **blocks = (char **)realloc(intern_blocks, (intern_block_count + 1) * sizeof(char *));
+		if (!blocks)
+			return false;
+		intern_blocks = blocks;
+		if (!(intern_blocks[intern_block_count] = (char *)malloc(block_size)))
+			return false;
+		intern_block_count++;
+		intern_block_used = 0;
+	}
+	return true;
 }
 
-void divide_single_channel_image_to_columns(unsigned char *image, int width, int height, unsigned char **left_column, unsigned char **right_column, int *final_width,
-											int *final_height) {
-
-	// Find the last row with a white pixel (255)
-	int last_white_row = -1;
-	for (int row = 0; row < height; row++) {
-		for (int col = 0; col < width; col++) {
-			if (image[row * width + col] == 255) {
-				last_white_row = row;
-				break;
-			}
-		}
+// Function to intern a name, returns the kept copy or NULL when no more names can be kept
+const char *intern_name(const char *text, size_t length) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ (uint8_t)text[i]) * 16777619u;
 	}
 
-	// Adjust the height based on last white row and division by 18
-	if (last_white_row != -1) {
-		int new_height = last_white_row + 1;
-		int remainder = (new_height - 2) % 18;
-		if (remainder != 0) {
-			new_height += (18 - remainder);
-		}
-		if (new_height > height) {
-			new_height = height;
+	for (uint32_t slot = hash & (intern_slot_count - 1); intern_slot_count && intern_slots[slot]; slot = (slot + 1) & (intern_slot_count - 1)) {
+		const char *name = intern_names[intern_slots[slot]];
+		if (strncmp(name, text, length) == 0 && name[length] == '\0')
+			return name;
+	}
+	if (intern_count == MAX_INTERNED_NAMES || !reserve_interned_name(length)) {
+		if (!intern_full) {
+			printf("Warning: no room for more than %d distinct names, names first read from now on are dropped\n", intern_count);
+			intern_full = true;
 		}
-		height = new_height;
+		return NULL;
 	}
 
-	// Skip the first two rows
-	image += 2 * width;
-	height -= 2;
+	char *name = intern_blocks[intern_block_count - 1] + intern_block_used;
+	memcpy(name, text, length);
+	name[length] = '\0';
+	intern_block_used += length + 1;
+	intern_names[++intern_count] = name;
 
-	// Validate dimensions
-	if (width % 2 != 0) {
-		printf("Error: Image width must be even to divide into two equal columns.\n");
-		return;
+	uint32_t slot = hash & (intern_slot_count - 1);
+	while (intern_slots[slot]) {
+		slot = (slot + 1) & (intern_slot_count - 1);
 	}
+	intern_slots[slot] = (uint32_t)intern_count;
+	return name;
+}
 
-	// Calculate dimensions for each column
-	int column_width = width / 2;
-
-	// Allocate memory for the left and right columns
-	*left_column = (unsigned char *)malloc(column_width * height * sizeof(unsigned char));
-	*right_column = (unsigned char *)malloc(column_width * height * sizeof(unsigned char));
+// Function to get the id of an interned name, 0 for NULL
+uint16_t interned_name_id(const char *name) {
+	if (!name || !intern_slot_count)
+		return 0;
 
-	if (!*left_column || !*right_column) {
-		printf("Error: Memory allocation failed.\n");
-		free(*left_column);
-		free(*right_column);
-		return;
+	uint32_t slot = hash_string(name) & (intern_slot_count - 1);
+	while (intern_slots[slot] && intern_names[intern_slots[slot]] != name) {
+		slot = (slot + 1) & (intern_slot_count - 1);
 	}
+	return (uint16_t)intern_slots[slot];
+}
+
+// Cursor over one line of recognized text
+typedef struct {
+	const char *at;
+	const char *end;
+} text_cursor;
+
+// Function to consume a literal at the cursor, returns false (cursor unchanged) if the text differs
+static bool parse_literal(text_cursor *cursor, const char *literal) {
+	size_t length = strlen(literal);
+	if ((size_t)(cursor->end - cursor->at) < length || memcmp(cursor->at, literal, length) != 0)
+		return false;
+	cursor->at += length;
+	return true;
+}
 
-	// Copy pixels to the left and right column images
-	for (int row = 0; row < height; row++) {
-		memcpy(*left_column + row * column_width, image + row * width, column_width);
-		memcpy(*right_column + row * column_width, image + row * width + column_width, column_width);
+// Function to skip spaces at the cursor
+static void skip_spaces(text_cursor *cursor) {
+	while (cursor->at < cursor->end && *cursor->at == ' ') {
+		cursor->at++;
 	}
+}
 
-	*final_width = column_width;
-	*final_height = height;
+// Function to parse an optionally negative decimal integer
+static bool parse_int(text_cursor *cursor, int *value) {
+	const char *at = cursor->at;
+	bool negative = at < cursor->end && *at == '-';
+	at += negative;
+
+	long long number = 0;
+	int digits = 0;
+	for (; at < cursor->end && isdigit((uint8_t)*at); at++) {
+		if (++digits > 10)
+			return false;
+		number = number * 10 + (*at - '0');
+	}
+	if (digits == 0 || number > INT32_MAX)
+		return false;
 
-	// printf("Image successfully divided into columns.\n");
+	*value = (int)(negative ? -number : number);
+	cursor->at = at;
+	return true;
 }
 
-// Function to determine if a column is completely black
-bool is_column_black(unsigned char *row, int column, int width, int cropped_height) {
-	for (int y = 0; y < cropped_height; y++) {
-		if (row[y * width + column] != 0) {
-			return false;
+// Function to parse an optionally negative decimal number with an optional fraction, F3 prints no exponents
+static bool parse_double(text_cursor *cursor, double *value) {
+	static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+	const char *at = cursor->at;
+	bool negative = at < cursor->end && *at == '-';
+	at += negative;
+
+	uint64_t mantissa = 0;
+	int digits = 0, significant_digits = 0, fraction_digits = 0, scale = 0;
+	bool fraction = false;
+	for (; at < cursor->end; at++) {
+		if (*at == '.' && !fraction) {
+			fraction = true;
+			continue;
 		}
+		if (!isdigit((uint8_t)*at))
+			break;
+		digits++;
+		if (significant_digits < 18 && fraction_digits < 18) {
+			mantissa = mantissa * 10 + (uint64_t)(*at - '0');
+			fraction_digits += fraction;
+			significant_digits += mantissa != 0;
+		} else if (!fraction) {
+			scale++; // Integer digits beyond the mantissa only scale it
+		}
+	}
+	if (digits == 0)
+		return false;
+
+	double number = (double)mantissa / powers_of_ten[fraction_digits];
+	for (; scale > 0; scale--) {
+		number *= 10;
 	}
+	*value = negative ? -number : number;
+	cursor->at = at;
 	return true;
 }
 
-// Function to determine if a column has any white pixels
-bool has_white_pixel(unsigned char *row, int column, int width, int cropped_height) {
-	for (int y = 0; y < cropped_height; y++) {
-		if (row[y * width + column] == 255) {
-			return true;
+// Function to parse three integers separated by the given separator, as in "0 -54 0" or "0, -53, 1"
+static bool parse_int_triple(text_cursor *cursor, const char *separator, int *a, int *b, int *c) {
+	return parse_int(cursor, a) && parse_literal(cursor, separator) && parse_int(cursor, b) && parse_literal(cursor, separator) && parse_int(cursor, c);
+}
+
+// Function to parse "Facing: south (Towards positive Z) (2.8 / 15.4)"
+static bool parse_facing(text_cursor cursor, f3_fields *fields) {
+	if (!parse_literal(&cursor, "Facing: "))
+		return false;
+
+	fields->facing = FACING_UNKNOWN;
+	for (int direction = FACING_NORTH; direction <= FACING_WEST; direction++) {
+		if (parse_literal(&cursor, facing_names[direction])) {
+			fields->facing = (facing_direction)direction;
+			break;
 		}
 	}
-	return false;
-}
 
-int character_index = 0;
+	// Rotation is in the last parentheses
+	const char *open = cursor.end;
+	while (open > cursor.at && open[-1] != '(') {
+		open--;
+	}
+	if (fields->facing == FACING_UNKNOWN || open == cursor.at)
+		return false;
+	cursor.at = open;
+	if (!parse_double(&cursor, &fields->yaw))
+		return false;
+	skip_spaces(&cursor);
+	if (!parse_literal(&cursor, "/"))
+		return false;
+	skip_spaces(&cursor);
+	return parse_double(&cursor, &fields->pitch) && parse_literal(&cursor, ")");
+}
 
-// Main function to process the row
-void extract_characters(const char *filename, unsigned char *cropped_row, int cropped_width, int cropped_height) {
-	int start_col = -1;
-	int space_count = 0;
+// Function to parse a namespaced name such as "minecraft:deepslate" spanning the rest of the cursor, and intern it
+static const char *parse_name(text_cursor cursor, f3_fields *fields) {
+	const char *colon = memchr(cursor.at, ':', cursor.end - cursor.at);
+	if (!colon || colon == cursor.at || colon + 1 == cursor.end)
+		return NULL;
+	for (const char *c = cursor.at; c < cursor.end; c++) {
+		if (*c == ' ' || *c == '?')
+			return NULL; // Not a single name, or a character that was not recognized
+	}
+	const char *name = intern_name(cursor.at, cursor.end - cursor.at);
+	fields->names_dropped |= !name;
+	return name;
+}
 
-	for (int col = 0; col < cropped_width; col++) {
-		if (is_column_black(cropped_row, col, cropped_width, cropped_height)) {
-			space_count++;
-			if (space_count == 8) {
-				start_col = col - 8;
-			}
-		} else {
-			space_count = 0;
+// Function to parse one line of F3 text into the frame fields; next is the following line, for the lines that continue on it
+void parse_f3_line(text_cursor line, text_cursor next, f3_fields *fields) {
+	text_cursor cursor = line;
+	if (parse_literal(&cursor, "XYZ: ")) {
+		fields->has_position = parse_double(&cursor, &fields->x) && parse_literal(&cursor, " / ") && parse_double(&cursor, &fields->y) &&
+							   parse_literal(&cursor, " / ") && parse_double(&cursor, &fields->z);
+	} else if (parse_literal(&cursor, "Block: ")) {
+		fields->has_block = parse_int_triple(&cursor, " ", &fields->block_x, &fields->block_y, &fields->block_z);
+	} else if (parse_literal(&cursor, "Chunk: ")) {
+		fields->has_chunk = parse_int_triple(&cursor, " ", &fields->chunk_x, &fields->chunk_y, &fields->chunk_z);
+	} else if (cursor.at < cursor.end && *cursor.at == 'F' && parse_facing(cursor, fields)) {
+		fields->has_facing = true;
+	} else if (parse_literal(&cursor, "Client Light: ")) {
+		fields->has_light = parse_int(&cursor, &fields->light) && parse_literal(&cursor, " (") && parse_int(&cursor, &fields->sky_light) &&
+							parse_literal(&cursor, " sky, ") && parse_int(&cursor, &fields->block_light) && parse_literal(&cursor, " block)");
+	} else if (parse_literal(&cursor, "Biome: ")) {
+		fields->biome = parse_name(cursor, fields);
+	} else if (parse_literal(&cursor, "Targeted Block: ")) {
+		fields->has_targeted_block = parse_int_triple(&cursor, ", ", &fields->targeted_block_x, &fields->targeted_block_y, &fields->targeted_block_z);
+		fields->targeted_block = fields->has_targeted_block ? parse_name(next, fields) : NULL;
+	} else if (parse_literal(&cursor, "Targeted Fluid: ")) {
+		fields->has_targeted_fluid = parse_int_triple(&cursor, ", ", &fields->targeted_fluid_x, &fields->targeted_fluid_y, &fields->targeted_fluid_z);
+		fields->targeted_fluid = fields->has_targeted_fluid ? parse_name(next, fields) : NULL;
+	} else {
+		// Dimension line: "minecraft:overworld FC: 0"
+		const char *space = memchr(cursor.at, ' ', cursor.end - cursor.at);
+		text_cursor rest = {space, cursor.end};
+		if (space && parse_literal(&rest, " FC: ")) {
+			text_cursor name = {cursor.at, space};
+			fields->dimension = parse_name(name, fields);
 		}
+	}
+}
 
-		if (has_white_pixel(cropped_row, col, cropped_width, cropped_height)) {
-			if (start_col == -1) {
-				start_col = col;
-			}
-		} else {
-			if (start_col != -1) {
-				int end_col = col - 1;
-				int char_width = end_col - start_col + 3; // Include 1-pixel black borders
+// Function to parse the recognized text of a frame into its typed fields, without allocating
+void parse_f3_fields(const text_buffer *text, f3_fields *fields) {
+	memset(fields, 0, sizeof(*fields));
+	const char *end = text->data + text->length;
+	const char *line = text->data;
+	while (line && line < end) {
+		const char *line_end = memchr(line, '\n', end - line);
+		line_end = line_end ? line_end : end;
+		const char *next = line_end < end ? line_end + 1 : end;
+		const char *next_end = next < end ? memchr(next, '\n', end - next) : NULL;
+
+		text_cursor cursor = {line, line_end};
+		text_cursor following = {next, next_end ? next_end : end};
+		parse_f3_line(cursor, following, fields);
+		line = next;
+	}
+}
 
-				// Allocate memory for the character
-				unsigned char *character = (unsigned char *)malloc(char_width * cropped_height);
-				if (!character) {
-					printf("Memory allocation failed for character extraction\n");
-					exit(EXIT_FAILURE);
-				}
+// Function to append a JSON number array of doubles or integers to a record
+void append_json_numbers(text_buffer *record, const char *key, const double *values, int count) {
+	char number[48];
+	snprintf(number, sizeof(number), ",\"%s\":[", key);
+	append_text(record, number, strlen(number));
+	for (int i = 0; i < count; i++) {
+		snprintf(number, sizeof(number), "%s%.15g", i ? "," : "", values[i]);
+		append_text(record, number, strlen(number));
+	}
+	append_text(record, "]", 1);
+}
 
-				// Copy the character data, including 1-pixel black borders
-				for (int y = 0; y < cropped_height; y++) {
-					for (int x = -1; x <= char_width - 2; x++) {
-						int src_col = start_col + x;
-						int dst_col = x + 1;
+// Function to append a JSON string field to a record, skipped when the value is NULL
+void append_json_name(text_buffer *record, const char *key, const char *value) {
+	if (!value)
+		return;
+	char prefix[48];
+	snprintf(prefix, sizeof(prefix), ",\"%s\":", key);
+	append_text(record, prefix, strlen(prefix));
+	append_json_string(record, value, strlen(value));
+}
 
-						if (src_col < 0 || src_col >= cropped_width) {
-							character[y * char_width + dst_col] = 0; // Black border
-						} else {
-							character[y * char_width + dst_col] = cropped_row[y * cropped_width + src_col];
-						}
-					}
-				}
+// Function to append the parsed fields of the frame to a record as JSON members, only the fields that were found
+void append_json_fields(text_buffer *record, const f3_fields *fields) {
+	if (fields->has_position) {
+		double values[] = {fields->x, fields->y, fields->z};
+		append_json_numbers(record, "xyz", values, 3);
+	}
+	if (fields->has_block) {
+		double values[] = {fields->block_x, fields->block_y, fields->block_z};
+		append_json_numbers(record, "block", values, 3);
+	}
+	if (fields->has_chunk) {
+		double values[] = {fields->chunk_x, fields->chunk_y, fields->chunk_z};
+		append_json_numbers(record, "chunk", values, 3);
+	}
+	if (fields->has_facing) {
+		double values[] = {fields->yaw, fields->pitch};
+		append_json_name(record, "facing", facing_names[fields->facing]);
+		append_json_numbers(record, "rotation", values, 2);
+	}
+	if (fields->has_light) {
+		double values[] = {fields->light, fields->sky_light, fields->block_light};
+		append_json_numbers(record, "light", values, 3);
+	}
+	append_json_name(record, "biome", fields->biome);
+	append_json_name(record, "dimension", fields->dimension);
+	if (fields->has_targeted_block) {
+		double values[] = {fields->targeted_block_x, fields->targeted_block_y, fields->targeted_block_z};
+		append_json_numbers(record, "targeted_block_position", values, 3);
+		append_json_name(record, "targeted_block", fields->targeted_block);
+	}
+	if (fields->has_targeted_fluid) {
+		double values[] = {fields->targeted_fluid_x, fields->targeted_fluid_y, fields->targeted_fluid_z};
+		append_json_numbers(record, "targeted_fluid_position", values, 3);
+		append_json_name(record, "targeted_fluid", fields->targeted_fluid);
+	}
+	if (fields->names_dropped) {
+		append_text(record, ",\"names_dropped\":true", 21);
+	}
+}
 
-				// Handle spaces (8 black columns in a row)
-				if (space_count == 8) {
-					space_count = 0;
-					for (int i = 0; i < cropped_height * char_width; i++) {
+// Function to seek to a byte offset from the start of a file, with 64-bit offsets since long is 32 bits on Windows
+bool seek_file(FILE *file, uint64_t offset) {
+#ifdef _WIN32
+	return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
 
-						character[i] = 0;
-					}
-				}
+// Function to get the size of an open file by seeking to its end, 0 when it cannot be found
+uint64_t file_end(FILE *file) {
+#ifdef _WIN32
+	__int64 offset = _fseeki64(file, 0, SEEK_END) == 0 ? _ftelli64(file) : -1;
+#else
+	off_t offset = fseeko(file, 0, SEEK_END) == 0 ? ftello(file) : -1;
+#endif
+	return offset > 0 ? (uint64_t)offset : 0;
+}
+
+// Function to cut an open file back to a length, its buffer must be empty
+bool truncate_file(FILE *file, uint64_t length) {
+#ifdef _WIN32
+	return _chsize_s(_fileno(file), (__int64)length) == 0;
+#else
+	return ftruncate(fileno(file), (off_t)length) == 0;
+#endif
+}
 
-				char matched_char = match_character(character, char_width, MATRIX_ROWS);
-				write_character_to_file(filename, matched_char);
+// Function to append the recognized frame to the dataset file as one JSON line, in a single write
+void write_dataset_record(const char *source, long long timestamp) {
+	char number[32];
+	dataset_record.length = 0;
+	if (dataset_stopped)
+		return;
 
-				// Free the allocated memory
-				free(character);
+	if (dataset_needs_newline) {
+		append_text(&dataset_record, "\n", 1);
+	}
+	append_text(&dataset_record, "{\"source\":", 10);
+	append_json_string(&dataset_record, source, strlen(source));
+	snprintf(number, sizeof(number), ",\"timestamp\":%lld", timestamp);
+	append_text(&dataset_record, number, strlen(number));
+	append_text(&dataset_record, ",\"lines\":", 9);
+	append_json_lines(&dataset_record, &frame_text);
+	append_json_fields(&dataset_record, &frame_fields);
+	if (confidence_filepath[0]) {
+		append_text(&dataset_record, ",\"confidence\":", 14);
+		append_json_lines(&dataset_record, &frame_confidence);
+	}
+	append_text(&dataset_record, "}\n", 2);
 
-				start_col = -1;
-			}
+	if (fwrite(dataset_record.data, 1, dataset_record.length, dataset_file) != dataset_record.length || fflush(dataset_file) != 0) {
+		perror("Error writing dataset file");
+
+		// Cut the partial record off, so the next record is not glued onto it. The file is unbuffered, so nothing of
+		// the failed record is left to be written later.
+		clearerr(dataset_file);
+		if (!truncate_file(dataset_file, dataset_length)) {
+			printf("Failed to remove a partial record, no more frames are appended to the dataset\n");
+			dataset_stopped = true;
 		}
+		return;
 	}
-	write_character_to_file(filename, '\n');
+	dataset_length = file_end(dataset_file);
+	dataset_needs_newline = false;
+	add_dataset_source(source);
 }
 
-// Function to divide a column into rows of given height, crop rows, and save them to files
-void recognize_and_save_text_from_columns(const char *filename, unsigned char *column, int width, int height) {
-	int num_rows = height / row_height;
-	for (int i = 0; i < num_rows; i++) {
-		// Extract the current row, skipping the first two rows
-		unsigned char *row = column + (i * row_height * width) + (2 * width);
-		int effective_height = row_height - 2;
-		if (effective_height <= 0)
-			continue; // Ensure valid height
+// Function to open the column files in a folder for appending, creating the folder and whatever is missing. Names
+// already in names.txt are interned first so they keep their ids; frames committed to every column are kept.
+bool open_column_files(const char *folder) {
+	char path[1024];
+#ifdef _WIN32
+	CreateDirectoryA(folder, NULL);
+#else
+	mkdir(folder, 0755);
+#endif
+
+	snprintf(path, sizeof(path), "%s/%s", folder, F3_COLUMNS_NAMES_FILE);
+	FILE *names = fopen(path, "rb");
+	if (names) {
+		char line[512];
+		while (fgets(line, sizeof(line), names)) {
+			size_t length = strcspn(line, "\r\n");
+			const char *name = intern_name(line, length);
+			if (!name || interned_name_id(name) != intern_count) {
+				printf("Invalid names file: %s\n", path);
+				fclose(names);
+				return false;
+			}
+		}
+		fclose(names);
+	}
+	column_names_written = intern_count;
+	if (!(column_names_file = fopen(path, "ab"))) {
+		printf("Failed to open names file: %s\n", path);
+		return false;
+	}
 
-		// Find the first and last column containing white pixels (255)
-		int first_col = -1, last_col = -1;
-		for (int x = 0; x < width; x++) {
-			for (int y = 0; y < effective_height; y++) {
-				if (row[y * width + x] == 255) {
-					if (first_col == -1)
-						first_col = x;
-					last_col = x;
+	column_frames = UINT64_MAX;
+	for (int column = 0; column < COLUMN_COUNT; column++) {
+		const column_descriptor *descriptor = &record_columns[column];
+		snprintf(path, sizeof(path), "%s/%s%s", folder, descriptor->name, F3_COLUMNS_EXTENSION);
+
+		f3_column_header header;
+		memset(&header, 0, sizeof(header));
+		FILE *file = fopen(path, "r+b");
+		if (file) {
+			if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, F3_COLUMNS_MAGIC, 4) != 0 || header.version != F3_COLUMNS_VERSION ||
+				header.type != descriptor->type || header.value_size != descriptor->size) {
+				printf("Not a %s column file: %s\n", descriptor->name, path);
+				fclose(file);
+				return false;
+			}
+		} else {
+			memcpy(header.magic, F3_COLUMNS_MAGIC, 4);
+			header.version = F3_COLUMNS_VERSION;
+			header.type = (uint16_t)descriptor->type;
+			header.value_size = descriptor->size;
+			file = fopen(path, "w+b");
+			if (!file || fwrite(&header, sizeof(header), 1, file) != 1) {
+				printf("Failed to create column file: %s\n", path);
+				if (file) {
+					fclose(file);
 				}
+				return false;
 			}
 		}
+		column_files[column] = file;
+		if (header.count < column_frames) {
+			column_frames = header.count;
+		}
+	}
 
-		// If no white pixel found, skip saving this row
-		if (first_col == -1 || last_col == -1) {
-			write_character_to_file(filename, '\n');
-			continue;
+	// Values past the committed frames were left by a run that stopped early, the next frames overwrite them
+	for (int column = 0; column < COLUMN_COUNT; column++) {
+		if (!seek_file(column_files[column], F3_COLUMN_DATA_OFFSET + column_frames * record_columns[column].size)) {
+			printf("Failed to seek in column file: %s/%s%s\n", folder, record_columns[column].name, F3_COLUMNS_EXTENSION);
+			return false;
 		}
+	}
+	columns_folder = folder;
+	return true;
+}
 
-		// Add a black border by including one column on both sides
-		first_col = (first_col > 0) ? first_col - 1 : first_col;
-		last_col = (last_col < width - 1) ? last_col + 1 : last_col;
+// Function to fill a column record from the parsed fields of the frame
+void fill_column_record(column_record *record, const f3_fields *fields, const char *source, long long timestamp) {
+	memset(record, 0, sizeof(*record));
+	record->timestamp = timestamp;
+	size_t source_length = strlen(source);
+	memcpy(record->source, source, source_length < sizeof(record->source) ? source_length : sizeof(record->source)); // Long names fill the value without a NUL
+	if (fields->has_position) {
+		record->fields |= F3_HAS_POSITION;
+		record->x = fields->x;
+		record->y = fields->y;
+		record->z = fields->z;
+	}
+	if (fields->has_block) {
+		record->fields |= F3_HAS_BLOCK;
+		record->block_x = fields->block_x;
+		record->block_y = fields->block_y;
+		record->block_z = fields->block_z;
+	}
+	if (fields->has_chunk) {
+		record->fields |= F3_HAS_CHUNK;
+		record->chunk_x = fields->chunk_x;
+		record->chunk_y = fields->chunk_y;
+		record->chunk_z = fields->chunk_z;
+	}
+	if (fields->has_facing) {
+		record->fields |= F3_HAS_FACING;
+		record->facing = (uint8_t)fields->facing;
+		record->yaw = (float)fields->yaw;
+		record->pitch = (float)fields->pitch;
+	}
+	if (fields->has_light) {
+		record->fields |= F3_HAS_LIGHT;
+		record->light = (uint8_t)fields->light;
+		record->sky_light = (uint8_t)fields->sky_light;
+		record->block_light = (uint8_t)fields->block_light;
+	}
+	record->biome = interned_name_id(fields->biome);
+	record->dimension = interned_name_id(fields->dimension);
+	if (fields->has_targeted_block) {
+		record->fields |= F3_HAS_TARGETED_BLOCK;
+		record->targeted_block_x = fields->targeted_block_x;
+		record->targeted_block_y = fields->targeted_block_y;
+		record->targeted_block_z = fields->targeted_block_z;
+		record->targeted_block = interned_name_id(fields->targeted_block);
+	}
+	if (fields->has_targeted_fluid) {
+		record->fields |= F3_HAS_TARGETED_FLUID;
+		record->targeted_fluid_x = fields->targeted_fluid_x;
+		record->targeted_fluid_y = fields->targeted_fluid_y;
+		record->targeted_fluid_z = fields->targeted_fluid_z;
+		record->targeted_fluid = interned_name_id(fields->targeted_fluid);
+	}
+	if (fields->names_dropped) {
+		record->fields |= F3_NAMES_DROPPED;
+	}
+}
 
-		int cropped_width = last_col - first_col + 1;
-		int cropped_height = effective_height;
+// Function to append the frame to every column file. Names first seen in the frame go to names.txt before the
+// frame count in each column header is raised, so a reader never sees an id it cannot look up.
+bool write_column_record(const char *source, long long timestamp) {
+	column_record record;
+	fill_column_record(&record, &frame_fields, source, timestamp);
 
-		unsigned char *cropped_row = (unsigned char *)malloc(cropped_width * cropped_height);
+	for (int column = 0; column < COLUMN_COUNT; column++) {
+		const column_descriptor *descriptor = &record_columns[column];
+		if (fwrite((const char *)&record + descriptor->offset, descriptor->size, 1, column_files[column]) != 1)
+			return false;
+	}
+	for (; column_names_written < intern_count; column_names_written++) {
+		const char *name = intern_names[column_names_written + 1];
+		if (fprintf(column_names_file, "%s\n", name) < 0)
+			return false;
+	}
+	if (fflush(column_names_file) != 0)
+		return false;
+
+	column_frames++;
+	for (int column = 0; column < COLUMN_COUNT; column++) {
+		FILE *file = column_files[column];
+		if (!seek_file(file, offsetof(f3_column_header, count)) || fwrite(&column_frames, sizeof(column_frames), 1, file) != 1 ||
+			!seek_file(file, F3_COLUMN_DATA_OFFSET + column_frames * record_columns[column].size))
+			return false;
+	}
+	return true;
+}
 
-		// Copy the cropped row data
-		for (int y = 0; y < cropped_height; y++) {
-			memcpy(cropped_row + y * cropped_width, row + y * width + first_col, cropped_width);
+// Function to close the column files
+void close_column_files(void) {
+	for (int column = 0; column < COLUMN_COUNT; column++) {
+		if (column_files[column]) {
+			fclose(column_files[column]);
 		}
+	}
+	if (column_names_file) {
+		fclose(column_names_file);
+	}
+}
 
-		extract_characters(filename, cropped_row, cropped_width, cropped_height);
-
-		free(cropped_row);
+// Function to set requested_fields from a comma-separated list of field names
+bool parse_field_list(const char *list) {
+	requested_fields = 0;
+	while (*list) {
+		size_t length = strcspn(list, ",");
+		int field = 0;
+		while (field < FIELD_LABEL_COUNT && (strlen(field_labels[field].name) != length || strncmp(field_labels[field].name, list, length) != 0)) {
+			field++;
+		}
+		if (field == FIELD_LABEL_COUNT) {
+			printf("Unknown field: %.*s\n", (int)length, list);
+			return false;
+		}
+		requested_fields |= 1u << field;
+		list += length + (list[length] == ',');
+	}
+	if (!requested_fields) {
+		printf("No fields given to --fields\n");
+		return false;
 	}
+	return true;
 }
 
 // Function to check if a corresponding .txt file exists in the output folder
@@ -362,7 +3109,14 @@ int txt_file_exists(const char *filename) {
 	return (stat(txt_filename, &buffer) == 0); // Returns 1 if file exists, 0 otherwise
 }
 
-// Function to get a list of .png filenames that do not have corresponding .txt files
+// Function to order file names for qsort
+int compare_filenames(const void *a, const void *b) {
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Function to get a list of .png filenames that do not have corresponding .txt files (or records in the dataset file
+// with --dataset, checked in memory instead of one stat per file), in name order, which for
+// Minecraft's timestamped screenshot names is capture order, so consecutive frames can share unchanged lines
 char **get_png_filenames(int *count) {
 	DIR *dir;
 	struct dirent *entry;
@@ -380,7 +3134,8 @@ char **get_png_filenames(int *count) {
 			strncpy(base_name, entry->d_name, strlen(entry->d_name) - 4); // Remove .png
 			base_name[strlen(entry->d_name) - 4] = '\0';
 
-			if (!txt_file_exists(base_name)) { // Check if .txt file does not exist
+			bool processed = dataset_file ? dataset_has_source(entry->d_name) : txt_file_exists(base_name);
+			if (!processed) { // Check if .txt file does not exist
 				filenames = realloc(filenames, (*count + 1) * sizeof(char *));
 				filenames[*count] = strdup(entry->d_name); // Store filename
 				(*count)++;
@@ -388,6 +3143,9 @@ char **get_png_filenames(int *count) {
 		}
 	}
 	closedir(dir);
+	if (*count > 1) {
+		qsort(filenames, *count, sizeof(char *), compare_filenames);
+	}
 	return filenames;
 }
 
@@ -399,10 +3157,131 @@ void remove_png_extension(char *filename) {
 	}
 }
 
-int main() {
+// Function to remove .txt from a filename
+void remove_txt_extension(char *filename) {
+	char *ext = strstr(filename, ".txt");
+	if (ext != NULL) {
+		*ext = '\0';
+	}
+}
+
+int main(int argc, char **argv) {
 	int width, height, channels, file_count;
+	const char *glyph_filename = NULL;
+	const char *glyph_set_output = NULL;
+	const char *profile_name = "auto";
+	bool write_confidence = false;
+	const char *dataset_filename = NULL;
+	const char *columns_filename = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--glyphs") == 0 && i + 1 < argc) {
+			glyph_filename = argv[++i];
+		} else if (strcmp(argv[i], "--write-glyph-set") == 0 && i + 1 < argc) {
+			glyph_set_output = argv[++i];
+		} else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+			profile_name = argv[++i];
+		} else if (strcmp(argv[i], "--max-distance") == 0 && i + 1 < argc) {
+			char *end;
+			const char *value = argv[++i];
+			long distance = strtol(value, &end, 10);
+			if (end == value || *end != '\0' || distance < 0 || distance > MATRIX_ROWS * MATRIX_COLS) {
+				printf("Invalid --max-distance: %s (a whole number of pixels from 0 to %d)\n", value, MATRIX_ROWS * MATRIX_COLS);
+				return 1;
+			}
+			max_glyph_distance = (int)distance;
+		} else if (strcmp(argv[i], "--confidence") == 0) {
+			write_confidence = true;
+		} else if (strcmp(argv[i], "--column-major") == 0) {
+			column_major_lines = true;
+		} else if (strcmp(argv[i], "--automaton") == 0) {
+			column_major_lines = use_column_automaton = true;
+		} else if (strcmp(argv[i], "--dataset") == 0 && i + 1 < argc) {
+			dataset_filename = argv[++i];
+		} else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc) {
+			columns_filename = argv[++i];
+		} else if (strcmp(argv[i], "--fields") == 0 && i + 1 < argc) {
+			if (!parse_field_list(argv[++i])) {
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--roi") == 0 && i + 1 < argc) {
+			const char *roi = argv[++i];
+			if (strcmp(roi, "auto") == 0) {
+				learn_panel_rois = true;
+			} else if (sscanf(roi, "%d,%d,%d,%d,%d,%d,%d,%d", &panel_rois[0].x, &panel_rois[0].y, &panel_rois[0].width, &panel_rois[0].height, &panel_rois[1].x,
+							  &panel_rois[1].y, &panel_rois[1].width, &panel_rois[1].height) == 8) {
+				panel_rois_set = true;
+			} else {
+				printf("Invalid panel regions: %s\n", roi);
+				return 1;
+			}
+		} else {
+			printf("Usage: %s [--glyphs <ascii_base.txt|glyphs.bin>] [--write-glyph-set <glyphs.bin>] [--profile auto|scale1|scale2|scale3|scale4]\n"
+				   "       [--max-distance <pixels>] [--confidence] [--roi auto|<left x,y,w,h>,<right x,y,w,h>] [--column-major] [--automaton]\n"
+				   "       [--dataset <frames.jsonl>] [--columns <folder>] [--fields <field,...>]\n",
+				   argv[0]);
+			return 1;
+		}
+	}
+
+	bool detect = strcmp(profile_name, "auto") == 0;
+	if (!detect) {
+		active_profile = find_profile(profile_name);
+		if (!active_profile) {
+			printf("Unknown profile: %s\n", profile_name);
+			return 1;
+		}
+	}
+
+	select_kernels();
+
+	// The default font is compiled in; a text or binary glyph-set file only overrides it. The set for the
+	// other base GUI scale is redrawn from whichever one was loaded.
+	glyph_set *loaded_glyphs = &default_font_glyphs[2];
+	use_builtin_glyphs(loaded_glyphs);
+	if (glyph_filename) {
+		bool loaded = is_glyph_set_file(glyph_filename) ? load_glyph_set_file(loaded_glyphs, glyph_filename) : load_ascii_matrices(loaded_glyphs, glyph_filename);
+		if (!loaded) {
+			printf("Failed to load glyph file: %s\n", glyph_filename);
+			return 1;
+		}
+	}
+	derive_glyph_set(&default_font_glyphs[1], loaded_glyphs, 1);
+	if (loaded_glyphs->gui_scale == 1) {
+		derive_glyph_set(&default_font_glyphs[2], &default_font_glyphs[1], 2);
+	}
+	build_glyph_index(&default_font_glyphs[1]);
+	build_glyph_index(&default_font_glyphs[2]);
+
+	if (glyph_set_output) {
+		const glyph_set *output_glyphs = active_profile ? active_profile->glyphs : &default_font_glyphs[2];
+		if (!write_glyph_set_file(output_glyphs, glyph_set_output)) {
+			return 1;
+		}
+		printf("Glyph set with %d glyphs written to: %s\n", output_glyphs->count, glyph_set_output);
+		return 0;
+	}
 
-	load_ascii_matrices("ascii_base.txt");
+	// Frames already in the dataset are read once, so they can be skipped without touching the file system per frame
+	if (dataset_filename) {
+		if (!load_dataset_sources(dataset_filename) || !(dataset_file = fopen(dataset_filename, "a"))) {
+			printf("Failed to open dataset file: %s\n", dataset_filename);
+			return 1;
+		}
+		setvbuf(dataset_file, NULL, _IONBF, 0); // Each record is written whole, see write_dataset_record
+		dataset_length = file_end(dataset_file);
+		printf("Appending frames to dataset: %s (%d already in it)\n", dataset_filename, dataset_source_count);
+	}
+	if (columns_filename) {
+		if (!open_column_files(columns_filename)) {
+			close_column_files();
+			return 1;
+		}
+		printf("Appending frames to columns in: %s (%llu already in them)\n", columns_filename, (unsigned long long)column_frames);
+	}
+
+	int profile_width = 0, profile_height = 0;
+	int roi_width = 0, roi_height = 0; // Frame size the learned panel regions belong to
 
 	// Get list of .png files that do not have corresponding .txt files
 	char **png_files = get_png_filenames(&file_count);
@@ -411,6 +3290,7 @@ int main() {
 		printf("No new PNG files found for processing.\n");
 	}
 
+	int redetected_frame = -1; // Frame recognized again after its unknown-glyph share made the profile suspect
 	for (int i = 0; i < file_count; i++) {
 		char filepath[512];
 		snprintf(filepath, sizeof(filepath), "%s%s", ASSETS_FOLDER, png_files[i]);
@@ -424,36 +3304,171 @@ int main() {
 
 		printf("Processing image: %s\n", filepath);
 
-		// Convert the filtered image to single-channel
-		unsigned char *single_channel_image = convert_to_single_channel(image, width, height, channels);
+		// Learned panel regions only hold for the resolution they were learned at
+		if (learn_panel_rois && panel_rois_set && (width != roi_width || height != roi_height)) {
+			panel_rois_set = false;
+		}
+
+		// Binarize straight into a bit plane, only within the panel regions when there are any
+		bit_plane single_channel_image;
+		bool whole_frame = !panel_rois_set;
+		bool binarized = binarize_image(image, width, height, channels, panel_rois, whole_frame ? 0 : 2, &single_channel_image);
+		if (!binarized) {
+			stbi_image_free(image);
+			free(png_files[i]);
+			continue;
+		}
+
+		// Detect the profile on the first frame, and again whenever the resolution changes
+		if (detect && (!active_profile || width != profile_width || height != profile_height)) {
+			active_profile = detect_profile(&single_channel_image);
+			if (!active_profile) {
+				active_profile = find_profile("scale2"); // Too little or too ambiguous text to tell, assume the default setup
+			}
+			profile_width = width;
+			profile_height = height;
+			printf("Using profile %s for %dx%d frames\n", active_profile->name, width, height);
+		}
+
+		// Text reaching the edge of a panel region may go on outside it, so take the whole frame instead
+		if (!whole_frame && !panel_regions_hold(&single_channel_image)) {
+			printf("Text reaches the edge of a panel region, binarizing the whole frame\n");
+			free(single_channel_image.bits);
+			whole_frame = true;
+			binarized = binarize_image(image, width, height, channels, NULL, 0, &single_channel_image);
+		}
+
+		// Release the decoded colour image, all later steps read the bit plane
+		stbi_image_free(image);
+		if (!binarized) {
+			free(png_files[i]);
+			continue;
+		}
+
+		// Divide the binarized image into the left and right F3 columns
+		plane_view left_column, right_column;
+		line_grid grid;
 
-		// Divide and save the single-channel image
-		unsigned char *left_column = NULL;
-		unsigned char *right_column = NULL;
-		int final_width = 0;
-		int final_height = 0;
+		if (!find_text_lines(&single_channel_image, &grid)) {
+			free(single_channel_image.bits);
+			free(png_files[i]);
+			continue;
+		}
+		bool divided = divide_single_channel_image_to_columns(&single_channel_image, &grid, &left_column, &right_column);
 
-		divide_single_channel_image_to_columns(single_channel_image, width, height, &left_column, &right_column, &final_width, &final_height);
+		// Learn the panel regions from the first whole frame, and from every frame that outgrew them
+		if (learn_panel_rois && whole_frame && divided) {
+			learn_panel_regions(&single_channel_image, &grid);
+			roi_width = width;
+			roi_height = height;
+		}
 
 		char output_filepath[512];
 		snprintf(output_filepath, sizeof(output_filepath), "%s%s", OUTPUT_FOLDER, png_files[i]);
 		remove_png_extension(output_filepath); // Remove .png
 		strcat(output_filepath, ".txt");	   // Append .txt
 
-		printf("Saving text to file: %s\n", output_filepath);
+		// Confidence digits go next to the text, one per recognized character
+		if (write_confidence) {
+			snprintf(confidence_filepath, sizeof(confidence_filepath), "%s", output_filepath);
+			remove_txt_extension(confidence_filepath);
+			strcat(confidence_filepath, ".conf");
+		}
 
 		// Divide and save rows for left and right columns
-		recognize_and_save_text_from_columns(output_filepath, left_column, final_width, final_height);
-		recognize_and_save_text_from_columns(output_filepath, right_column, final_width, final_height);
+		current_location.source = png_files[i];
+		if (divided && prepare_frame_lines(&current_frame, grid.count)) {
+			current_location.side = "left";
+			frame_text.length = frame_confidence.length = 0;
+			frame_glyphs = frame_unknown_glyphs = 0;
+			recognize_and_save_text_from_columns(&single_channel_image, &left_column, &grid, 1);
+			current_location.side = "right";
+			recognize_and_save_text_from_columns(&single_channel_image, &right_column, &grid, 2);
+
+			// A GUI scale change at the same resolution shows up as a frame of unknown glyphs: detect the profile
+			// again, and when it changed, recognize the frame once more with the new one
+			if (detect && redetected_frame != i && frame_glyphs >= MIN_REDETECT_GLYPHS && frame_unknown_glyphs * 100 > frame_glyphs * REDETECT_UNKNOWN_PERCENT) {
+				const glyph_profile *detected = detect_profile(&single_channel_image);
+				if (detected && detected != active_profile) {
+					printf("Too many unknown glyphs, using profile %s for %dx%d frames\n", detected->name, width, height);
+					settle_pending_glyphs(false);
+					active_profile = detected;
+					redetected_frame = i--;
+					free(grid.ink);
+					free(single_channel_image.bits);
+					continue;
+				}
+			}
+			settle_pending_glyphs(true);
+			remember_frame(&single_channel_image, &grid);
+
+			parse_f3_fields(&frame_text, &frame_fields);
+
+			// One write per output file for the whole frame, or one record in the dataset stamped with the capture's modification time
+			struct stat png_stat;
+			long long timestamp = (dataset_file || columns_folder) && stat(filepath, &png_stat) == 0 ? (long long)png_stat.st_mtime : 0;
+			if (columns_folder && !write_column_record(png_files[i], timestamp)) {
+				perror("Error writing column files");
+				columns_folder = NULL; // The frames committed so far stay readable
+			}
+			if (dataset_file) {
+				write_dataset_record(png_files[i], timestamp);
+			} else {
+				printf("Saving text to file: %s\n", output_filepath);
+				write_text_to_file(output_filepath, frame_text.data, frame_text.length);
+				if (confidence_filepath[0]) {
+					write_text_to_file(confidence_filepath, frame_confidence.data, frame_confidence.length);
+				}
+			}
+		}
 
-		free(left_column);
-		free(right_column);
-		free(single_channel_image);
+		free(grid.ink);
+		free(single_channel_image.bits);
 		free(png_files[i]);
-		stbi_image_free(image);
 	}
 
 	free(png_files);
+	write_unknown_glyphs();
+	free(unknown_glyphs);
+	free(unknown_glyph_index);
+	free(pending_glyphs);
+	for (int set = 0; set < LINE_CACHE_SETS; set++) {
+		for (int way = 0; way < LINE_CACHE_WAYS; way++) {
+			free(line_cache[set][way].text.data);
+			free(line_cache[set][way].confidence.data);
+		}
+	}
+	free(line_text.data);
+	free(line_confidence.data);
+	free(frame_text.data);
+	free(frame_confidence.data);
+	free(dataset_record.data);
+	for (int slot = 0; slot < dataset_source_capacity; slot++) {
+		free(dataset_sources[slot]);
+	}
+	free(dataset_sources);
+	for (int block = 0; block < intern_block_count; block++) {
+		free(intern_blocks[block]);
+	}
+	free(intern_blocks);
+	free((void *)intern_names);
+	free(intern_slots);
+	if (dataset_file) {
+		fclose(dataset_file);
+	}
+	close_column_files();
+	frame_lines *frames[2] = {&current_frame, &previous_frame};
+	for (int frame = 0; frame < 2; frame++) {
+		for (int side = 0; side < 2; side++) {
+			for (int line = 0; line < frames[frame]->line_capacity; line++) {
+				free(frames[frame]->text[side][line].data);
+				free(frames[frame]->confidence[side][line].data);
+			}
+			free(frames[frame]->text[side]);
+			free(frames[frame]->confidence[side]);
+		}
+		free(frames[frame]->plane.bits);
+	}
 
 	system("pause");
 	return 0;